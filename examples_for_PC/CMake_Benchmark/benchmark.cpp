@@ -0,0 +1,528 @@
+// LovyanGFX drawing primitive benchmark.
+//
+// Drives LGFX_Sprite and Panel_Headless (a Panel_FrameBufferBase kept in
+// RAM) with no display attached, and reports calls/s and pixels/s for each
+// primitive, colour depth and rotation.
+// floodFill is additionally measured on generated mazes at 320x240 and
+// 1024x768, independent of --width / --height.
+// pushImage / pushAlphaImage with bgr888, rgb332 and argb8888 sources cover
+// the pixelcopy_t format conversions.
+// Each --jpeg file is decoded with drawJpg into sprites of the image size
+// (16 and 24 bpp), which measures JPEG decode throughput over a corpus.
+//
+// usage: LGFX_Benchmark [--width N] [--height N] [--time SEC] [--json PATH|-]
+//                       [--jpeg PATH]...
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+#include <lgfx/v1/gitTagVersion.h>
+
+//----------------------------------------------------------------------------
+
+class LGFX_Headless : public lgfx::LGFX_Device
+{
+  lgfx::Panel_Headless _panel_instance;
+public:
+  LGFX_Headless(int width, int height)
+  {
+    auto cfg = _panel_instance.config();
+    cfg.memory_width  = cfg.panel_width  = width;
+    cfg.memory_height = cfg.panel_height = height;
+    _panel_instance.config(cfg);
+    setPanel(&_panel_instance);
+  }
+};
+
+//----------------------------------------------------------------------------
+
+struct result_t
+{
+  const char* target;
+  const char* primitive;
+  int depth;
+  int rotation;
+  uint64_t calls;
+  uint64_t pixels;
+  double seconds;
+};
+
+static std::vector<result_t> results;
+static double time_per_case = 0.2;
+static FILE* table_out = stdout;
+
+// Deterministic pseudo random numbers, so every run draws the same shapes.
+static uint32_t lcg_state;
+static inline uint32_t lcg(uint32_t range)
+{
+  lcg_state = lcg_state * 1664525u + 1013904223u;
+  return (uint32_t)(((uint64_t)(lcg_state >> 8) * range) >> 24);
+}
+
+static uint16_t image_data[64 * 64];
+static lgfx::bgr888_t image_bgr888[64 * 64];
+static lgfx::rgb332_t image_rgb332[64 * 64];
+static lgfx::argb8888_t image_argb8888[64 * 64];
+static uint8_t* png_data = nullptr;
+static size_t png_len = 0;
+static const int png_w = 64, png_h = 64;
+
+// draw() performs one call and returns the number of pixels it covered.
+template <typename TFunc>
+static void run_case(const char* target, const char* primitive, lgfx::LovyanGFX* gfx, TFunc draw)
+{
+  using clock = std::chrono::steady_clock;
+  lcg_state = 12345;
+  uint64_t calls = 0;
+  uint64_t pixels = 0;
+  uint32_t batch = 1;
+  auto start = clock::now();
+  double elapsed = 0;
+  do
+  {
+    for (uint32_t i = 0; i < batch; ++i)
+    {
+      pixels += draw(gfx);
+    }
+    calls += batch;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    if (batch < 4096) { batch <<= 1; }
+  } while (elapsed < time_per_case);
+
+  results.push_back({ target, primitive, (int)gfx->getColorDepth() & lgfx::color_depth_t::bit_mask, gfx->getRotation(), calls, pixels, elapsed });
+  auto& r = results.back();
+  fprintf(table_out, "%-12s %-22s %2d bpp  rot %d  %12.0f calls/s  %10.2f Mpix/s\n"
+        , r.target, r.primitive, r.depth, r.rotation
+        , r.calls / r.seconds, r.pixels / r.seconds / 1000000.0);
+}
+
+static void run_primitives(const char* target, lgfx::LovyanGFX* gfx)
+{
+  int32_t w = gfx->width();
+  int32_t h = gfx->height();
+
+  run_case(target, "fillRect", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t rw = 1 + lcg(w >> 1);
+    int32_t rh = 1 + lcg(h >> 1);
+    g->fillRect(lcg(w - rw), lcg(h - rh), rw, rh, lcg(0x10000));
+    return rw * rh;
+  });
+
+  run_case(target, "drawLine", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t x0 = lcg(w), y0 = lcg(h), x1 = lcg(w), y1 = lcg(h);
+    g->drawLine(x0, y0, x1, y1, lcg(0x10000));
+    return 1 + std::max(abs(x1 - x0), abs(y1 - y0));
+  });
+
+  run_case(target, "fillCircle", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t r = 1 + lcg(std::min(w, h) >> 2);
+    g->fillCircle(lcg(w), lcg(h), r, lcg(0x10000));
+    return (uint32_t)(3.14159f * r * r);
+  });
+
+  run_case(target, "fillTriangle", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t x0 = lcg(w), y0 = lcg(h), x1 = lcg(w), y1 = lcg(h), x2 = lcg(w), y2 = lcg(h);
+    g->fillTriangle(x0, y0, x1, y1, x2, y2, lcg(0x10000));
+    return 1 + (abs((x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0)) >> 1);
+  });
+
+  // 10-point stars, pixels counted as the outer radius bounding box / 2
+  run_case(target, "fillPolygon", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t r = 8 + lcg(h >> 2);
+    int32_t cx = lcg(w), cy = lcg(h);
+    lgfx::point_t pts[10];
+    for (int i = 0; i < 10; ++i)
+    {
+      float a = i * 3.14159f / 5, rr = (i & 1) ? r * 0.5f : r;
+      pts[i] = { cx + (int32_t)(rr * cosf(a)), cy + (int32_t)(rr * sinf(a)) };
+    }
+    g->fillPolygon(pts, 10, lcg(0x10000));
+    return 2 * r * r;
+  });
+
+  run_case(target, "fillSmoothPolygon", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    float r = 8 + lcg(h >> 2);
+    float cx = lcg(w), cy = lcg(h);
+    lgfx::pointf_t pts[10];
+    for (int i = 0; i < 10; ++i)
+    {
+      float a = i * 3.14159f / 5, rr = (i & 1) ? r * 0.5f : r;
+      pts[i] = { cx + rr * cosf(a), cy + rr * sinf(a) };
+    }
+    g->fillSmoothPolygon(pts, 10, lcg(0x10000));
+    return (uint32_t)(2 * r * r);
+  });
+
+  run_case(target, "fillSmoothRoundRect", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t rw = 16 + lcg(w >> 1);
+    int32_t rh = 16 + lcg(h >> 1);
+    g->fillSmoothRoundRect(lcg(w - rw), lcg(h - rh), rw, rh, 2 + lcg(6), lcg(0x10000));
+    return rw * rh;
+  });
+
+  run_case(target, "drawWideLine", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t x0 = lcg(w), y0 = lcg(h), x1 = lcg(w), y1 = lcg(h);
+    float r = 0.5f + lcg(16) * 0.5f;
+    g->drawWideLine(x0, y0, x1, y1, r, lcg(0x10000));
+    return (uint32_t)((1 + std::max(abs(x1 - x0), abs(y1 - y0))) * (r * 2 + 1));
+  });
+
+  run_case(target, "drawWedgeLine", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    int32_t x0 = w >> 1, y0 = h >> 1, x1 = lcg(w), y1 = lcg(h);
+    g->drawWedgeLine(x0, y0, x1, y1, 6.0f, 1.0f, lcg(0x10000));
+    return (uint32_t)((1 + std::max(abs(x1 - x0), abs(y1 - y0))) * 8);
+  });
+
+  gfx->setFont(&fonts::Font2);
+  gfx->setTextColor(TFT_WHITE, TFT_BLACK);
+  static const char text[] = "The quick brown fox 0123456789";
+  int32_t tw = gfx->textWidth(text);
+  int32_t th = gfx->fontHeight();
+  run_case(target, "drawString", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    g->drawString(text, lcg(std::max(1, w - tw)), lcg(std::max(1, h - th)));
+    return tw * th;
+  });
+  lgfx::LGFX_TextRunCache text_cache;
+  gfx->setTextRunCache(&text_cache);
+  run_case(target, "drawString (run cache)", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    g->drawString(text, lcg(std::max(1, w - tw)), lcg(std::max(1, h - th)));
+    return tw * th;
+  });
+  gfx->setTextRunCache(nullptr);
+  gfx->setFont(nullptr);
+
+  run_case(target, "pushImage", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    g->pushImage(lcg(w - 64), lcg(h - 64), 64, 64, image_data);
+    return 64 * 64;
+  });
+
+  // pixelcopy_t format conversions (vectorised for some source / destination pairs)
+  run_case(target, "pushImage bgr888", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    g->pushImage(lcg(w - 64), lcg(h - 64), 64, 64, image_bgr888);
+    return 64 * 64;
+  });
+
+  run_case(target, "pushImage rgb332", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    g->pushImage(lcg(w - 64), lcg(h - 64), 64, 64, image_rgb332);
+    return 64 * 64;
+  });
+
+  run_case(target, "pushAlphaImage", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    g->pushAlphaImage(lcg(w - 64), lcg(h - 64), 64, 64, image_argb8888);
+    return 64 * 64;
+  });
+
+  LGFX_Sprite src;
+  src.setColorDepth(16);
+  src.createSprite(64, 64);
+  src.pushImage(0, 0, 64, 64, image_data);
+  run_case(target, "pushRotateZoomWithAA", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    float zoom = 0.5f + lcg(256) / 128.0f;
+    src.pushRotateZoomWithAA(g, lcg(w), lcg(h), lcg(360), zoom, zoom);
+    return (uint32_t)(64 * 64 * zoom * zoom);
+  });
+
+  run_case(target, "drawPng", gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    g->drawPng(png_data, png_len, lcg(w - png_w), lcg(h - png_h));
+    return png_w * png_h;
+  });
+}
+
+struct jpeg_file_t
+{
+  std::string name;
+  std::vector<uint8_t> data;
+  int width;
+  int height;
+};
+
+// Reads a JPEG file and takes the image size from its SOFn segment.
+static bool load_jpeg(const char* path, jpeg_file_t* jpg)
+{
+  FILE* fp = fopen(path, "rb");
+  if (fp == nullptr) { return false; }
+  uint8_t buf[4096];
+  size_t len;
+  while (0 < (len = fread(buf, 1, sizeof(buf), fp)))
+  {
+    jpg->data.insert(jpg->data.end(), buf, buf + len);
+  }
+  fclose(fp);
+
+  auto& d = jpg->data;
+  size_t i = 2;
+  while (i + 9 < d.size() && d[i] == 0xFF)
+  {
+    uint8_t marker = d[i + 1];
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+    {
+      jpg->height = d[i + 5] << 8 | d[i + 6];
+      jpg->width  = d[i + 7] << 8 | d[i + 8];
+      const char* base = strrchr(path, '/');
+      jpg->name = std::string("drawJpg ") + (base ? base + 1 : path);
+      return jpg->width > 0 && jpg->height > 0;
+    }
+    i += 2 + (d[i + 2] << 8 | d[i + 3]);
+  }
+  return false;
+}
+
+// Carve a perfect maze with 1 pixel corridors (recursive backtracker) and
+// return the number of corridor pixels.
+static uint32_t draw_maze(lgfx::LovyanGFX* gfx, uint32_t wall, uint32_t path)
+{
+  int32_t cw = (gfx->width()  - 1) >> 1;
+  int32_t ch = (gfx->height() - 1) >> 1;
+  std::vector<uint8_t> visited(cw * ch, 0);
+  std::vector<int32_t> stack;
+  gfx->fillScreen(wall);
+  lcg_state = 4321;
+  stack.push_back(0);
+  visited[0] = 1;
+  gfx->drawPixel(1, 1, path);
+  uint32_t pixels = 1;
+  while (!stack.empty())
+  {
+    int32_t c = stack.back();
+    int32_t cx = c % cw, cy = c / cw;
+    int32_t next[4];
+    int n = 0;
+    if (cx > 0      && !visited[c - 1 ]) { next[n++] = c - 1;  }
+    if (cx < cw - 1 && !visited[c + 1 ]) { next[n++] = c + 1;  }
+    if (cy > 0      && !visited[c - cw]) { next[n++] = c - cw; }
+    if (cy < ch - 1 && !visited[c + cw]) { next[n++] = c + cw; }
+    if (n == 0) { stack.pop_back(); continue; }
+    int32_t nc = next[lcg(n)];
+    int32_t nx = nc % cw, ny = nc / cw;
+    visited[nc] = 1;
+    gfx->drawPixel(1 + cx + nx, 1 + cy + ny, path);
+    gfx->drawPixel(1 + nx * 2, 1 + ny * 2, path);
+    pixels += 2;
+    stack.push_back(nc);
+  }
+  return pixels;
+}
+
+static void run_maze(const char* target, const char* primitive, lgfx::LovyanGFX* gfx)
+{
+  static const uint32_t colors[2] = { TFT_WHITE, TFT_RED };
+  uint32_t pixels = draw_maze(gfx, TFT_BLACK, colors[0]);
+  uint32_t turn = 0;
+  run_case(target, primitive, gfx, [&](lgfx::LovyanGFX* g) -> uint32_t
+  {
+    // every call refills the whole corridor network with the other colour.
+    g->floodFill(1, 1, colors[++turn & 1]);
+    return pixels;
+  });
+}
+
+static void write_json(FILE* fp, int width, int height)
+{
+  fprintf(fp, "{\n  \"library\": \"LovyanGFX\",\n  \"version\": \"%d.%d.%d\",\n"
+             , LGFX_VERSION_MAJOR, LGFX_VERSION_MINOR, LGFX_VERSION_PATCH);
+  fprintf(fp, "  \"width\": %d,\n  \"height\": %d,\n  \"results\": [\n", width, height);
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    auto& r = results[i];
+    fprintf(fp, "    { \"target\": \"%s\", \"primitive\": \"%s\", \"depth\": %d, \"rotation\": %d"
+                ", \"calls\": %llu, \"pixels\": %llu, \"seconds\": %.6f"
+                ", \"calls_per_sec\": %.1f, \"pixels_per_sec\": %.1f }%s\n"
+          , r.target, r.primitive, r.depth, r.rotation
+          , (unsigned long long)r.calls, (unsigned long long)r.pixels, r.seconds
+          , r.calls / r.seconds, r.pixels / r.seconds
+          , (i + 1 < results.size()) ? "," : "");
+  }
+  fprintf(fp, "  ]\n}\n");
+}
+
+int main(int argc, char** argv)
+{
+  int width = 320;
+  int height = 240;
+  const char* json_path = nullptr;
+  std::vector<jpeg_file_t> jpegs;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    bool has_value = i + 1 < argc;
+    if      (has_value && !strcmp(argv[i], "--width"))  { width  = atoi(argv[++i]); }
+    else if (has_value && !strcmp(argv[i], "--height")) { height = atoi(argv[++i]); }
+    else if (has_value && !strcmp(argv[i], "--time"))   { time_per_case = atof(argv[++i]); }
+    else if (has_value && !strcmp(argv[i], "--json"))   { json_path = argv[++i]; }
+    else if (has_value && !strcmp(argv[i], "--jpeg"))
+    {
+      jpegs.emplace_back();
+      if (!load_jpeg(argv[++i], &jpegs.back()))
+      {
+        fprintf(stderr, "cannot read jpeg %s\n", argv[i]);
+        return 1;
+      }
+    }
+    else
+    {
+      fprintf(stderr, "usage: %s [--width N] [--height N] [--time SEC] [--json PATH|-] [--jpeg PATH]...\n", argv[0]);
+      return 1;
+    }
+  }
+  if (json_path && !strcmp(json_path, "-")) { table_out = stderr; }
+  if (width < 128 || height < 128)
+  {
+    fprintf(stderr, "width and height must be 128 or more\n");
+    return 1;
+  }
+
+  for (int i = 0; i < 64 * 64; ++i)
+  {
+    int x = i & 63, y = i >> 6;
+    image_data[i] = lgfx::color565(x << 2, y << 2, (x ^ y) << 2);
+    image_bgr888[i].set(x << 2, y << 2, (x ^ y) << 2);
+    image_rgb332[i].set(x << 2, y << 2, (x ^ y) << 2);
+    image_argb8888[i].set((x + y) << 1, x << 2, y << 2, (x ^ y) << 2);
+  }
+  {
+    LGFX_Sprite png_src;
+    png_src.setColorDepth(24);
+    png_src.createSprite(png_w, png_h);
+    for (int y = 0; y < png_h; ++y)
+    {
+      for (int x = 0; x < png_w; ++x)
+      {
+        png_src.drawPixel(x, y, png_src.color888(x << 2, y << 2, (x * y) & 255));
+      }
+    }
+    png_data = (uint8_t*)png_src.createPng(&png_len, 0, 0, png_w, png_h);
+    if (png_data == nullptr)
+    {
+      fprintf(stderr, "createPng failed\n");
+      return 1;
+    }
+  }
+
+  static const int depths[] = { 8, 16, 24 };
+  for (int depth : depths)
+  {
+    LGFX_Sprite sprite;
+    sprite.setColorDepth(depth);
+    if (!sprite.createSprite(width, height))
+    {
+      fprintf(stderr, "createSprite failed\n");
+      return 1;
+    }
+    for (int rotation = 0; rotation < 4; ++rotation)
+    {
+      sprite.setRotation(rotation);
+      sprite.fillScreen(TFT_BLACK);
+      run_primitives("sprite", &sprite);
+    }
+  }
+
+  LGFX_Headless display(width, height);
+  if (!display.init())
+  {
+    fprintf(stderr, "panel init failed\n");
+    return 1;
+  }
+  for (int depth : depths)
+  {
+    display.setColorDepth(depth);
+    for (int rotation = 0; rotation < 4; ++rotation)
+    {
+      display.setRotation(rotation);
+      display.fillScreen(TFT_BLACK);
+      run_primitives("framebuffer", &display);
+    }
+  }
+
+  static const struct { int width, height; const char* name; } mazes[] =
+  { { 320, 240, "floodFill maze 320x240" }
+  , { 1024, 768, "floodFill maze 1024x768" }
+  };
+  for (auto& maze : mazes)
+  {
+    for (int depth : depths)
+    {
+      LGFX_Sprite sprite;
+      sprite.setColorDepth(depth);
+      if (!sprite.createSprite(maze.width, maze.height))
+      {
+        fprintf(stderr, "createSprite failed\n");
+        return 1;
+      }
+      run_maze("sprite", maze.name, &sprite);
+    }
+    LGFX_Headless maze_display(maze.width, maze.height);
+    if (!maze_display.init())
+    {
+      fprintf(stderr, "panel init failed\n");
+      return 1;
+    }
+    for (int depth : depths)
+    {
+      maze_display.setColorDepth(depth);
+      run_maze("framebuffer", maze.name, &maze_display);
+    }
+  }
+
+  static const int jpeg_depths[] = { 16, 24 };
+  for (auto& jpg : jpegs)
+  {
+    for (int depth : jpeg_depths)
+    {
+      LGFX_Sprite sprite;
+      sprite.setColorDepth(depth);
+      if (!sprite.createSprite(jpg.width, jpg.height))
+      {
+        fprintf(stderr, "createSprite failed\n");
+        return 1;
+      }
+      if (!sprite.drawJpg(jpg.data.data(), jpg.data.size(), 0, 0))
+      {
+        fprintf(stderr, "drawJpg failed: %s\n", jpg.name.c_str());
+        break;
+      }
+      run_case("sprite", jpg.name.c_str(), &sprite, [&](lgfx::LovyanGFX* g) -> uint32_t
+      {
+        g->drawJpg(jpg.data.data(), jpg.data.size(), 0, 0);
+        return jpg.width * jpg.height;
+      });
+    }
+  }
+
+  free(png_data);
+
+  if (json_path)
+  {
+    FILE* fp = strcmp(json_path, "-") ? fopen(json_path, "w") : stdout;
+    if (fp == nullptr)
+    {
+      fprintf(stderr, "cannot open %s\n", json_path);
+      return 1;
+    }
+    write_json(fp, width, height);
+    if (fp != stdout) { fclose(fp); }
+  }
+  return 0;
+}
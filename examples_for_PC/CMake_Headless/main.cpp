@@ -0,0 +1,46 @@
+#include <stdio.h>
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+// 表示装置を使わずにRAM上へ描画し、display() の度に PNG ファイルを出力する
+// Draw into RAM without any display, and write a PNG file on each display() call.
+
+class LGFX : public lgfx::LGFX_Device
+{
+  lgfx::Panel_Headless _panel_instance;
+public:
+  LGFX(int width, int height)
+  {
+    auto cfg = _panel_instance.config();
+    cfg.memory_width  = cfg.panel_width  = width;
+    cfg.memory_height = cfg.panel_height = height;
+    _panel_instance.config(cfg);
+    setPanel(&_panel_instance);
+  }
+  lgfx::Panel_Headless* panel(void) { return &_panel_instance; }
+};
+
+LGFX lcd ( 320, 240 );
+
+int main(int, char**)
+{
+  lcd.init();
+  lcd.panel()->setDumpFormat(lgfx::Panel_Headless::dump_png);
+  lcd.panel()->setDumpPath("frame_%03u.png");
+
+  for (int i = 0; i < 8; ++i)
+  {
+    lcd.fillScreen(TFT_BLACK);
+    lcd.fillCircle(40 + i * 30, 120, 30, TFT_RED);
+    lcd.setCursor(0, 0);
+    lcd.printf("frame %d", i);
+    lcd.display();
+  }
+
+  // The frame memory can also be read directly without encoding.
+  auto fb = lcd.panel()->getFrameBuffer();
+  printf("%u frames, first byte %02x, stride %u\n"
+        , (unsigned)lcd.panel()->getFrameCount(), fb[0], (unsigned)lcd.panel()->getFrameStride());
+  return 0;
+}
@@ -0,0 +1,33 @@
+// Minimal check helpers shared by the regression tests.
+// A test returns test_result() from main; ctest treats a non zero exit as failure.
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+
+static int test_failures = 0;
+
+#define TEST_CHECK(cond, ...) \
+  do { \
+    if (!(cond)) { \
+      ++test_failures; \
+      fprintf(stderr, "%s:%d: check failed: %s : ", __FILE__, __LINE__, #cond); \
+      fprintf(stderr, __VA_ARGS__); \
+      fputc('\n', stderr); \
+    } \
+  } while (0)
+
+static inline int test_result(const char* name)
+{
+  if (test_failures) { fprintf(stderr, "%s: %d check(s) failed\n", name, test_failures); }
+  else               { printf("%s: ok\n", name); }
+  return test_failures ? 1 : 0;
+}
+
+// Deterministic pseudo random numbers, so every run checks the same data.
+static uint32_t test_rand_state = 12345;
+static inline uint32_t test_rand(void)
+{
+  test_rand_state = test_rand_state * 1664525u + 1013904223u;
+  return test_rand_state >> 8;
+}
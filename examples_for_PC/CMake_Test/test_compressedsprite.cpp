@@ -0,0 +1,69 @@
+// LGFX_CompressedSprite must draw exactly what its source sprite draws,
+// including rotated / zoomed output of odd sized images and sources that
+// were drawn with setRotation.
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+#include "test_common.hpp"
+
+static int count_diff(LGFX_Sprite& a, LGFX_Sprite& b)
+{
+  int diff = 0;
+  for (int y = 0; y < a.height(); ++y)
+  {
+    for (int x = 0; x < a.width(); ++x) { diff += a.readPixel(x, y) != b.readPixel(x, y); }
+  }
+  return diff;
+}
+
+static void check_size(int w, int h, int rotation = 0)
+{
+  LGFX_Sprite src;
+  src.setColorDepth(16);
+  src.createSprite(w, h);
+  src.setRotation(rotation);
+  for (int y = 0; y < src.height(); ++y)
+  {
+    for (int x = 0; x < src.width(); ++x) { src.drawPixel(x, y, src.color888(x * 9, y * 7, (x ^ y) < 8 ? 0 : 255)); }
+  }
+
+  LGFX_CompressedSprite comp;
+  TEST_CHECK(comp.createFromSprite(&src), "%dx%d createFromSprite", w, h);
+  TEST_CHECK(comp.getPivotX() == src.getPivotX() && comp.getPivotY() == src.getPivotY()
+            , "%dx%d pivot %g,%g expected %g,%g", w, h, comp.getPivotX(), comp.getPivotY(), src.getPivotX(), src.getPivotY());
+
+  LGFX_Sprite expect, actual;
+  expect.setColorDepth(16);
+  actual.setColorDepth(16);
+  expect.createSprite(96, 96);
+  actual.createSprite(96, 96);
+
+  expect.clear();
+  actual.clear();
+  src.pushSprite(&expect, 3, 5);
+  comp.pushSprite(&actual, 3, 5);
+  TEST_CHECK(count_diff(expect, actual) == 0, "%dx%d pushSprite", w, h);
+
+  static const float angles[] = { 0, 30, 90, 217 };
+  for (float angle : angles)
+  {
+    expect.clear();
+    actual.clear();
+    src.pushRotateZoom(&expect, 48, 48, angle, 1.5f, 1.25f);
+    comp.pushRotateZoom(&actual, 48, 48, angle, 1.5f, 1.25f);
+    int diff = count_diff(expect, actual);
+    TEST_CHECK(diff == 0, "%dx%d pushRotateZoom angle %g : %d pixels differ", w, h, angle, diff);
+  }
+}
+
+int main(void)
+{
+  check_size(32, 24);
+  check_size(33, 25);
+  check_size(17, 40);
+  check_size(30, 20, 1);
+  check_size(33, 25, 3);
+  check_size(17, 40, 6);
+  return test_result("test_compressedsprite");
+}
@@ -0,0 +1,66 @@
+// Compares floodFill with a plain 4-connected breadth first fill on random
+// two-colour images, including tall ones that make the row cache grow.
+
+#include <vector>
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+#include "test_common.hpp"
+
+static void check_fill(int depth, int w, int h, int density)
+{
+  LGFX_Sprite sprite;
+  sprite.setColorDepth(depth);
+  if (!sprite.createSprite(w, h)) { TEST_CHECK(false, "createSprite %dx%d", w, h); return; }
+
+  const uint32_t wall = TFT_BLACK, open = TFT_WHITE, fill = TFT_RED;
+  std::vector<uint8_t> ref(w * h);
+  for (int i = 0; i < w * h; ++i)
+  {
+    ref[i] = (int)(test_rand() % 100) >= density;
+    sprite.drawPixel(i % w, i / w, ref[i] ? open : wall);
+  }
+  int sx = w >> 1, sy = h >> 1;
+  ref[sx + sy * w] = 1;
+  sprite.drawPixel(sx, sy, open);
+
+  std::vector<int> queue { sx + sy * w };
+  ref[sx + sy * w] = 2;
+  for (size_t q = 0; q < queue.size(); ++q)
+  {
+    int i = queue[q], x = i % w, y = i / w;
+    int next[4] = { x > 0 ? i - 1 : -1, x < w - 1 ? i + 1 : -1, y > 0 ? i - w : -1, y < h - 1 ? i + w : -1 };
+    for (int n : next)
+    {
+      if (n >= 0 && ref[n] == 1) { ref[n] = 2; queue.push_back(n); }
+    }
+  }
+
+  TEST_CHECK(sprite.floodFill(sx, sy, fill), "%d bpp %dx%d floodFill reported failure", depth, w, h);
+
+  LGFX_Sprite expect;
+  expect.setColorDepth(depth);
+  expect.createSprite(w, h);
+  static const uint32_t colors[3] = { wall, open, fill };
+  for (int i = 0; i < w * h; ++i) { expect.drawPixel(i % w, i / w, colors[ref[i]]); }
+
+  int wrong = 0;
+  for (int i = 0; i < w * h; ++i)
+  {
+    wrong += sprite.readPixel(i % w, i / w) != expect.readPixel(i % w, i / w);
+  }
+  TEST_CHECK(wrong == 0, "%d bpp %dx%d density %d : %d pixels differ", depth, w, h, density, wrong);
+}
+
+int main(void)
+{
+  static const int depths[] = { 16, 24 };
+  for (int depth : depths)
+  {
+    check_fill(depth, 64, 48, 30);
+    check_fill(depth, 200, 150, 40);
+    check_fill(depth, 40, 600, 35);
+  }
+  return test_result("test_floodfill");
+}
@@ -0,0 +1,84 @@
+// Progressive JPEG (SOF2) headers whose coefficient buffer would not fit
+// in 32 bits must be rejected before anything is allocated or decoded.
+
+#include <vector>
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+#include <lgfx/utility/lgfx_tjpgd.h>
+
+#include "test_common.hpp"
+
+// Grayscale progressive JPEG with a single DC scan. Every DC difference is
+// coded as category 0 (a single 0 bit), so the entropy data is all zero.
+static std::vector<uint8_t> make_progressive_gray(uint16_t width, uint16_t height, size_t data_len)
+{
+  std::vector<uint8_t> j = { 0xFF, 0xD8 };                         // SOI
+  j.insert(j.end(), { 0xFF, 0xDB, 0x00, 0x43, 0x00 });            // DQT table 0
+  j.insert(j.end(), 64, 1);
+  j.insert(j.end(), { 0xFF, 0xC4, 0x00, 0x14, 0x00, 1 });         // DHT DC table 0 : one 1-bit code
+  j.insert(j.end(), 15, 0);
+  j.push_back(0);                                                  // symbol : category 0
+  j.insert(j.end(), { 0xFF, 0xC2, 0x00, 0x0B, 8                    // SOF2, 8 bit
+                    , (uint8_t)(height >> 8), (uint8_t)height
+                    , (uint8_t)(width  >> 8), (uint8_t)width
+                    , 1, 1, 0x11, 0 });                            // 1 component, id 1, 1x1, table 0
+  j.insert(j.end(), { 0xFF, 0xDA, 0x00, 0x08, 1, 1, 0x00, 0, 0, 0x00 }); // SOS : DC first scan
+  j.insert(j.end(), data_len, 0);
+  j.insert(j.end(), { 0xFF, 0xD9 });                               // EOI
+  return j;
+}
+
+struct mem_reader_t { const std::vector<uint8_t>* data; size_t pos; };
+
+static uint32_t mem_read(void* dev, uint8_t* buf, uint32_t len)
+{
+  auto r = static_cast<mem_reader_t*>(dev);
+  size_t remain = r->data->size() - r->pos;
+  if (len > remain) { len = remain; }
+  if (buf) { memcpy(buf, r->data->data() + r->pos, len); }
+  r->pos += len;
+  return len;
+}
+
+static JRESULT prepare(const std::vector<uint8_t>& jpg, lgfxJdec* jd)
+{
+  static uint8_t pool[3900];
+  mem_reader_t reader = { &jpg, 0 };
+  return lgfx_jd_prepare(jd, mem_read, pool, sizeof(pool), &reader);
+}
+
+int main(void)
+{
+  LGFX_Sprite sprite;
+  sprite.setColorDepth(16);
+  sprite.createSprite(32, 32);
+
+  {
+    auto jpg = make_progressive_gray(16, 8, 64);
+    lgfxJdec jd;
+    JRESULT res = prepare(jpg, &jd);
+    TEST_CHECK(res == JDR_OK, "small image prepare %d", res);
+    TEST_CHECK(jd.sz_coef == 2 * 64 * sizeof(int16_t), "small image sz_coef %u", (unsigned)jd.sz_coef);
+    TEST_CHECK(sprite.drawJpg(jpg.data(), jpg.size()), "small image drawJpg");
+  }
+
+  // 65535 x 32776 : the coefficient buffer is about 4 GB and wrapped to about 1 MB in 32 bits.
+  {
+    auto jpg = make_progressive_gray(65535, 32776, 8192);
+    lgfxJdec jd;
+    JRESULT res = prepare(jpg, &jd);
+    TEST_CHECK(res == JDR_MEM1, "huge image prepare %d", res);
+    TEST_CHECK(!sprite.drawJpg(jpg.data(), jpg.size()), "huge image drawJpg");
+  }
+
+  // just above the limit
+  {
+    auto jpg = make_progressive_gray(8192, (JD_SZCOEF_MAX / (1024 * 128) + 1) * 8, 64);
+    lgfxJdec jd;
+    JRESULT res = prepare(jpg, &jd);
+    TEST_CHECK(res == JDR_MEM1, "limit + 1 row prepare %d", res);
+  }
+
+  return test_result("test_jpeg");
+}
@@ -0,0 +1,124 @@
+// Compares the vectorised pixelcopy_t paths (misc/pixelcopy_simd.hpp) with
+// the scalar conversion, pixel by pixel, for every run length up to a few
+// vector widths and for several starting offsets.
+
+#include <cstring>
+#include <vector>
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+#include "test_common.hpp"
+
+using namespace lgfx::v1;
+
+static constexpr uint32_t max_len = 70;
+static constexpr uint32_t max_ofs = 5;
+
+template <typename T>
+static void fill_random(std::vector<T>& v)
+{
+  auto p = reinterpret_cast<uint8_t*>(v.data());
+  for (size_t i = 0; i < v.size() * sizeof(T); ++i) { p[i] = test_rand(); }
+}
+
+template <typename T>
+static bool same_pixel(const T& a, const T& b) { return memcmp(&a, &b, sizeof(T)) == 0; }
+
+template <typename TDst, typename TSrc>
+static void check_copy(const char* name)
+{
+  // one extra vector of slack, as the kernels are allowed to read past the run.
+  std::vector<TSrc> src(max_ofs + max_len + 16);
+  std::vector<TDst> dst(max_ofs + max_len + 16);
+  std::vector<TDst> ref;
+  for (uint32_t ofs = 0; ofs < max_ofs; ++ofs)
+  {
+    for (uint32_t len = 1; len <= max_len; ++len)
+    {
+      fill_random(src);
+      fill_random(dst);
+      ref = dst;
+      for (uint32_t i = 0; i < len; ++i)
+      {
+        ref[ofs + i].set(color_convert<TDst, TSrc>(src[i].get()));
+      }
+
+      auto fast = dst;
+      pixelcopy_t pc;
+      pc.src_data = src.data();
+      pc.positions[0] = 0;
+      pixelcopy_t::copy_rgb_fast<TDst, TSrc>(fast.data(), ofs, ofs + len, &pc);
+
+      auto affine = dst;
+      pixelcopy_t pa;
+      pa.src_data = src.data();
+      pa.src_bitwidth = max_len;
+      pa.src_x32 = 0;
+      pa.src_y32 = 0;
+      pixelcopy_t::copy_rgb_affine<TDst, TSrc>(affine.data(), ofs, ofs + len, &pa);
+
+      for (size_t i = 0; i < dst.size(); ++i)
+      {
+        TEST_CHECK(same_pixel(fast[i], ref[i]), "%s copy_rgb_fast ofs %u len %u pixel %zu", name, ofs, len, i);
+        TEST_CHECK(same_pixel(affine[i], ref[i]), "%s copy_rgb_affine ofs %u len %u pixel %zu", name, ofs, len, i);
+      }
+      TEST_CHECK(pa.src_x32 == (len << pixelcopy_t::FP_SCALE), "%s copy_rgb_affine src_x32 %u len %u", name, pa.src_x32, len);
+    }
+  }
+}
+
+template <typename TDst, typename TSrc>
+static void check_blend(const char* name)
+{
+  std::vector<TSrc> src(max_ofs + max_len + 16);
+  std::vector<TDst> dst(max_ofs + max_len + 16);
+  for (uint32_t ofs = 0; ofs < max_ofs; ++ofs)
+  {
+    for (uint32_t len = 1; len <= max_len; ++len)
+    {
+      fill_random(src);
+      fill_random(dst);
+      // make sure the fully transparent and fully opaque cases are covered.
+      for (uint32_t i = 0; i < len; i += 3) { src[i].a = (i & 1) ? 255 : 0; }
+      auto ref = dst;
+      for (uint32_t i = 0; i < len; ++i)
+      {
+        auto& s = src[i];
+        auto& d = ref[ofs + i];
+        uint_fast16_t a = s.a;
+        if (a == 0) continue;
+        if (a == 255) { d.set(s.R8(), s.G8(), s.B8()); continue; }
+        uint_fast16_t inv = 256 - a;
+        ++a;
+        d.set( (d.R8() * inv + s.R8() * a) >> 8
+             , (d.G8() * inv + s.G8() * a) >> 8
+             , (d.B8() * inv + s.B8() * a) >> 8);
+      }
+
+      auto fast = dst;
+      pixelcopy_t pc;
+      pc.src_data = src.data();
+      pc.src_bitwidth = max_len;
+      pc.src_x32 = 0;
+      pc.src_y32 = 0;
+      pixelcopy_t::blend_rgb_fast<TDst, TSrc>(fast.data(), ofs, ofs + len, &pc);
+
+      for (size_t i = 0; i < dst.size(); ++i)
+      {
+        TEST_CHECK(same_pixel(fast[i], ref[i]), "%s blend_rgb_fast ofs %u len %u pixel %zu", name, ofs, len, i);
+      }
+    }
+  }
+}
+
+int main(void)
+{
+  check_copy<bgr888_t, swap565_t>("swap565 -> bgr888");
+  check_copy<swap565_t, bgr888_t>("bgr888 -> swap565");
+  check_copy<swap565_t, rgb332_t>("rgb332 -> swap565");
+  check_blend<swap565_t, argb8888_t>("argb8888 over swap565");
+  check_blend<bgr888_t, argb8888_t>("argb8888 over bgr888");
+
+  return test_result("test_pixelcopy");
+}
@@ -0,0 +1,132 @@
+// fillPolygon / fillSmoothPolygon with vertices far outside the drawing area.
+// fillPolygon is compared with an exact winding number reference, and both
+// are compared with the same shape given by vertices inside the 16.16 range.
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+#include "test_common.hpp"
+
+using lgfx::point_t;
+using lgfx::pointf_t;
+
+static constexpr int W = 96;
+static constexpr int H = 64;
+
+// fillPolygon draws a pixel when the winding number at its center is inside.
+// An edge covers the rows y0 <= y < y1, and a crossing exactly on the center counts as left of it.
+// Returns -1 when an edge crosses within 1/256 pixel of the center, where 16.16 rounding may decide either way.
+static int reference_inside(const point_t* p, size_t count, int px, int py, bool evenodd)
+{
+  int wind = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    int64_t x0 = p[(i + count - 1) % count].x, y0 = p[(i + count - 1) % count].y;
+    int64_t x1 = p[i].x, y1 = p[i].y;
+    int dir = 1;
+    if (y0 > y1) { std::swap(x0, x1); std::swap(y0, y1); dir = -1; }
+    if (py < y0 || py >= y1) continue;
+    double cross = x0 + (double)(py - y0) * (x1 - x0) / (y1 - y0);
+    if (fabs(cross - px) < 1.0 / 256) return -1;
+    if (cross < px) wind += dir;
+  }
+  return evenodd ? (wind & 1) : (wind != 0);
+}
+
+static void check_exact(const char* name, const point_t* p, size_t count, lgfx::fill_rule_t rule)
+{
+  LGFX_Sprite sp;
+  sp.setColorDepth(8);
+  sp.createSprite(W, H);
+  sp.clear(0);
+  sp.fillPolygon(p, count, TFT_WHITE, rule);
+
+  int diff = 0;
+  for (int y = 0; y < H; ++y)
+  {
+    for (int x = 0; x < W; ++x)
+    {
+      int expect = reference_inside(p, count, x, y, rule == lgfx::EVENODD);
+      if (expect >= 0) { diff += (sp.readPixel(x, y) != 0) != (bool)expect; }
+    }
+  }
+  TEST_CHECK(diff == 0, "%s fillPolygon : %d pixels differ", name, diff);
+}
+
+static int count_diff(LGFX_Sprite& a, LGFX_Sprite& b)
+{
+  int diff = 0;
+  for (int y = 0; y < H; ++y)
+  {
+    for (int x = 0; x < W; ++x) { diff += a.readPixel(x, y) != b.readPixel(x, y); }
+  }
+  return diff;
+}
+
+// near / far describe the same shape inside the sprite, far has vertices beyond the 16.16 range.
+static void check_same(const char* name, const pointf_t* near, const pointf_t* far, size_t count)
+{
+  LGFX_Sprite a, b;
+  a.setColorDepth(16);
+  b.setColorDepth(16);
+  a.createSprite(W, H);
+  b.createSprite(W, H);
+
+  point_t ni[8], fi[8];
+  for (size_t i = 0; i < count; ++i)
+  {
+    ni[i] = { (int32_t)near[i].x, (int32_t)near[i].y };
+    fi[i] = { (int32_t)far[i].x, (int32_t)far[i].y };
+  }
+  a.clear();
+  b.clear();
+  a.fillPolygon(ni, count, TFT_WHITE);
+  b.fillPolygon(fi, count, TFT_WHITE);
+  int diff = count_diff(a, b);
+  TEST_CHECK(diff == 0, "%s fillPolygon : %d pixels differ", name, diff);
+
+  a.clear();
+  b.clear();
+  a.fillSmoothPolygon(near, count, TFT_WHITE);
+  b.fillSmoothPolygon(far, count, TFT_WHITE);
+  diff = count_diff(a, b);
+  TEST_CHECK(diff == 0, "%s fillSmoothPolygon : %d pixels differ", name, diff);
+}
+
+int main(void)
+{
+  { point_t p[] = { {10,10}, {60000,30}, {20,50} }; check_exact("far right", p, 3, lgfx::NONZERO); }
+  { point_t p[] = { {-70000,-5}, {80,20}, {5,60} }; check_exact("far left", p, 3, lgfx::NONZERO); }
+  { point_t p[] = { {40,-100000}, {90,60}, {3,40} }; check_exact("far top", p, 3, lgfx::NONZERO); }
+  { point_t p[] = { {-2000000000,2000000000}, {2000000000,2000000000}, {48,-3} }; check_exact("huge", p, 3, lgfx::NONZERO); }
+  {
+    point_t p[] = { {48,2}, {-50000,40000}, {94,20}, {2,20}, {99999,-30000} };
+    check_exact("star nonzero", p, 5, lgfx::NONZERO);
+    check_exact("star evenodd", p, 5, lgfx::EVENODD);
+  }
+  {
+    for (int n = 0; n < 50; ++n)
+    {
+      point_t p[6];
+      for (auto& v : p)
+      {
+        v.x = (int32_t)(test_rand() % 200000) - 100000;
+        v.y = (int32_t)(test_rand() % 200000) - 100000;
+        if (test_rand() & 1) { v.x = test_rand() % W; v.y = test_rand() % H; }
+      }
+      check_exact("random", p, 6, (n & 1) ? lgfx::EVENODD : lgfx::NONZERO);
+    }
+  }
+
+  {
+    const pointf_t near[] = { {0,0}, {30,90}, {0,90} };
+    const pointf_t far[]  = { {0,0}, {30000,90000}, {0,90000} };
+    check_same("slope", near, far, 3);
+  }
+  {
+    const pointf_t near[] = { {-10,4}, {200,4}, {200,30}, {-10,30} };
+    const pointf_t far[]  = { {-100000,4}, {100000,4}, {100000,30}, {-100000,30} };
+    check_same("band", near, far, 4);
+  }
+  return test_result("test_polygon");
+}
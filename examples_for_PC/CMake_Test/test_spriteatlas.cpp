@@ -0,0 +1,115 @@
+// Sub-images drawn through LGFX_SpriteAtlas must match the same region of
+// the atlas drawn directly with pushImage. Covers sub-byte depths with an
+// atlas width that is not a multiple of 8, where the row stride in pixels
+// differs from the width, and sprites packed with a rotation set.
+
+#define LGFX_USE_V1
+#include <LovyanGFX.hpp>
+
+#include "test_common.hpp"
+
+static void check_depth(int depth, int atlas_w)
+{
+  LGFX_SpriteAtlas atlas;
+  atlas.setColorDepth(depth);
+  if (!atlas.createAtlas(atlas_w, 40)) { TEST_CHECK(false, "%d bpp createAtlas", depth); return; }
+  if (depth <= 8) { atlas.createPalette(); }
+
+  static const lgfx::LGFX_SpriteAtlas::rect_t sizes[] = { {0,0,7,5}, {0,0,11,9}, {0,0,13,4}, {0,0,6,12}, {0,0,9,7} };
+  uint16_t ids[5];
+  for (int i = 0; i < 5; ++i)
+  {
+    int32_t id = atlas.addSubImage(sizes[i].w, sizes[i].h);
+    TEST_CHECK(id >= 0, "%d bpp addSubImage %d", depth, i);
+    ids[i] = id < 0 ? 0 : id;
+  }
+  uint32_t colors = 1u << std::min(depth, 8);
+  for (int y = 0; y < atlas.height(); ++y)
+  {
+    for (int x = 0; x < atlas.width(); ++x) { atlas.drawPixel(x, y, test_rand() % colors); }
+  }
+
+  LGFX_Sprite expect, actual;
+  expect.setColorDepth(16);
+  actual.setColorDepth(16);
+  expect.createSprite(64, 64);
+  actual.createSprite(64, 64);
+  expect.clear();
+  actual.clear();
+
+  lgfx::LGFX_SpriteAtlas::blit_t list[5];
+  for (int i = 0; i < 5; ++i)
+  {
+    auto r = atlas.getSubImage(ids[i]);
+    list[i] = { 2 + i * 11, 3 + i * 9, ids[i] };
+    // reference : the same pixels copied one by one through readPixel.
+    for (int y = 0; y < r->h; ++y)
+    {
+      for (int x = 0; x < r->w; ++x)
+      {
+        expect.drawPixel(list[i].x + x, list[i].y + y, atlas.readPixelRGB(r->x + x, r->y + y));
+      }
+    }
+  }
+  atlas.pushSubImages(&actual, list, 5);
+
+  int diff = 0;
+  for (int y = 0; y < 64; ++y)
+  {
+    for (int x = 0; x < 64; ++x) { diff += expect.readPixel(x, y) != actual.readPixel(x, y); }
+  }
+  TEST_CHECK(diff == 0, "%d bpp atlas width %d : %d pixels differ", depth, atlas_w, diff);
+}
+
+// addSubImage(LGFX_Sprite*) must reserve the unrotated buffer size and
+// leave the neighbouring sub-images alone.
+static void check_rotated_source(int rotation)
+{
+  LGFX_SpriteAtlas atlas;
+  atlas.setColorDepth(16);
+  if (!atlas.createAtlas(64, 64)) { TEST_CHECK(false, "rotation %d createAtlas", rotation); return; }
+  atlas.fillScreen(TFT_BLUE);
+
+  LGFX_Sprite src;
+  src.setColorDepth(16);
+  src.createSprite(30, 12);
+  src.setRotation(rotation);
+  for (int y = 0; y < src.height(); ++y)
+  {
+    for (int x = 0; x < src.width(); ++x) { src.drawPixel(x, y, src.color888(x * 8, y * 5, 128)); }
+  }
+
+  int32_t id = atlas.addSubImage(&src);
+  int32_t next = atlas.addSubImage(5, 5);
+  TEST_CHECK(id >= 0 && next >= 0, "rotation %d addSubImage", rotation);
+  if (id < 0 || next < 0) { return; }
+  auto r = atlas.getSubImage(id);
+  TEST_CHECK(r->w == 30 && r->h == 12, "rotation %d sub-image size %dx%d", rotation, r->w, r->h);
+
+  LGFX_Sprite expect;
+  expect.setColorDepth(16);
+  expect.createSprite(64, 64);
+  expect.fillScreen(TFT_BLUE);
+  // anything drawn outside the reserved area is an overflow into other sub-images.
+  expect.setClipRect(r->x, r->y, r->w, r->h);
+  src.pushSprite(&expect, r->x, r->y);
+
+  int diff = 0;
+  for (int y = 0; y < 64; ++y)
+  {
+    for (int x = 0; x < 64; ++x) { diff += expect.readPixel(x, y) != atlas.readPixel(x, y); }
+  }
+  TEST_CHECK(diff == 0, "rotation %d : %d pixels differ", rotation, diff);
+}
+
+int main(void)
+{
+  check_depth(1, 30);
+  check_depth(2, 30);
+  check_depth(4, 29);
+  check_depth(8, 30);
+  check_depth(16, 30);
+  check_rotated_source(1);
+  check_rotated_source(3);
+  return test_result("test_spriteatlas");
+}
@@ -24,6 +24,8 @@
 / add support grayscale jpeg
 / add bayer pattern
 / tweak for 32bit processor
+/ add progressive JPEG (SOF2) support
+/ add decoding of a range of restart intervals
 /----------------------------------------------------------------------------*/
 
 #include "lgfx_tjpgd.h"
@@ -208,18 +210,34 @@ static int32_t create_huffman_tbl (	/* 0:OK, !0:Failed */
 		if (d & 0xEE) return JDR_FMT1;		/* Err: invalid class/number */
 		uint_fast8_t cls = d >> 4;			/* class = dc(0)/ac(1), table number = 0/1 */
 		uint_fast8_t num = d & 0x0F;
-		pb = alloc_pool(jd, 16);			/* Allocate a memory block for the bit distribution table */
-		if (!pb) return JDR_MEM1;			/* Err: not enough memory */
-		jd->huffbits[num][cls] = pb - 1;
 		np = 0;
 		size_t i = 0;
-		do {								/* Load number of patterns for 1 to 16-bit code */
-			np += (pb[i] = data[i]);		/* Get sum of code words for each code */
+		do {								/* Get sum of code words for each code */
+			np += data[i];
 		} while (++i < 16);
 
-		ph = (uint16_t*)alloc_pool(jd, np * sizeof (uint16_t));/* Allocate a memory block for the code word table */
-		if (!ph) return JDR_MEM1;			/* Err: not enough memory */
-		jd->huffcode[num][cls] = ph - 1;
+		if (jd->huffbits[num][cls] && jd->huffcap[num][cls] >= np) {
+			/* Overwrite the previous table. (Progressive JPEG redefines the tables between the scans) */
+			pb = jd->huffbits[num][cls] + 1;
+			ph = jd->huffcode[num][cls] + 1;
+			pd = jd->huffdata[num][cls] + 1;
+		} else {
+			uint_fast16_t cap = np;
+			if (jd->progressive) {			/* Reserve the maximum size to be reused by the following scans */
+				uint_fast16_t max = cls ? 162 : 16;
+				if (cap < max) cap = max;
+			}
+			pb = alloc_pool(jd, 16);		/* Allocate a memory block for the bit distribution table */
+			ph = (uint16_t*)alloc_pool(jd, cap * sizeof (uint16_t));/* Allocate a memory block for the code word table */
+			pd = alloc_pool(jd, cap);		/* Allocate a memory block for the decoded data */
+			if (!pb || !ph || !pd) return JDR_MEM1;	/* Err: not enough memory */
+			jd->huffbits[num][cls] = pb - 1;
+			jd->huffcode[num][cls] = ph - 1;
+			jd->huffdata[num][cls] = pd - 1;
+			jd->huffcap[num][cls] = cap;
+		}
+		memcpy(pb, data, 16);				/* Load number of patterns for 1 to 16-bit code */
+
 		uint_fast16_t hc = 0;
 		i = 0;
 		do {								/* Re-build huffman code word table */
@@ -228,10 +246,6 @@ static int32_t create_huffman_tbl (	/* 0:OK, !0:Failed */
 			hc <<= 1;
 		} while (++i < 16);
 
-		pd = alloc_pool(jd, np);			/* Allocate a memory block for the decoded data */
-		if (!pd) return JDR_MEM1;			/* Err: not enough memory */
-		jd->huffdata[num][cls] = pd - 1;
-
 		memcpy(pd, data += 16, np);			/* Load decoded data corresponds to each code ward */
 		data += np;
 	} while (ndata -= 17 + np);
@@ -517,6 +531,7 @@ static JRESULT mcu_load (
 			if (b < 0) return (JRESULT)(-b);	/* Err: invalid code or input error */
 			i += b >> 4;						/* Number of leading zero elements   Skip zero elements */
 			if (b &= 0x0F) {					/* Bit length */
+				if (i > 63) return JDR_FMT1;	/* Err: run length exceeds the block (may be collapted data) */
 				d = bitext(jd, b);				/* Extract data bits */
 				if (d < 0) return (JRESULT)(-d);/* Err: input device */
 				b = 1 << (b - 1);				/* MSB position */
@@ -558,7 +573,10 @@ static JRESULT mcu_output (
 	int32_t yy, cb, cr;
 	int16_t *py, *pc;
 	uint8_t *rgb24;
+	uint16_t *rgb16;
 	JRECT rect;
+	uint_fast8_t fmt16 = (jd->scale == 0) ? jd->format : 0;	/* 16-bit output is built directly only when not descaling */
+	uint_fast8_t bpp = 3;	/* Bytes per pixel in the working buffer */
 
 	mx = jd->msx << 3; my = jd->msy << 3;					/* MCU size (pixel) */
 	rx = (mx < jd->width - x) ? mx : jd->width - x;	/* Output rectangular size (it may be clipped at right/bottom end) */
@@ -581,6 +599,8 @@ static JRESULT mcu_output (
 
 		/* Build an RGB MCU from discrete comopnents */
 		rgb24 = workbuf;
+		rgb16 = (uint16_t*)workbuf;
+		if (fmt16) bpp = 2;
 		iy = 0;
 		do {
 #if JD_BAYER
@@ -600,19 +620,37 @@ static JRESULT mcu_output (
 					int32_t gg = ((int32_t)(0.34414 * (1<<FP_SHIFT)) * cb
 									  + (int32_t)(0.71414 * (1<<FP_SHIFT)) * cr) >> FP_SHIFT;
 					int32_t bb = ((int32_t)(1.772   * (1<<FP_SHIFT)) * cb) >> FP_SHIFT;
-					do {
+					if (!fmt16) {
+						do {
 #if JD_BAYER
-						yy = *py + btbl[ix & 3];		/* Get Y component */
+							yy = *py + btbl[ix & 3];		/* Get Y component */
 #else
-						yy = *py;					/* Get Y component */
+							yy = *py;					/* Get Y component */
 #endif
-						++py;
-					/* Convert YCbCr to RGB */
-						rgb24[0] = BYTECLIP(yy + rr);
-						rgb24[1] = BYTECLIP(yy - gg);
-						rgb24[2] = BYTECLIP(yy + bb);
-						rgb24 += 3;
-					} while (++ix & ixshift);
+							++py;
+						/* Convert YCbCr to RGB */
+							rgb24[0] = BYTECLIP(yy + rr);
+							rgb24[1] = BYTECLIP(yy - gg);
+							rgb24[2] = BYTECLIP(yy + bb);
+							rgb24 += 3;
+						} while (++ix & ixshift);
+					} else {
+						do {
+#if JD_BAYER
+							yy = *py + btbl[ix & 3];		/* Get Y component */
+#else
+							yy = *py;					/* Get Y component */
+#endif
+							++py;
+						/* Convert YCbCr to RGB565 directly */
+							uint_fast16_t r = BYTECLIP(yy + rr);
+							uint_fast16_t g = BYTECLIP(yy - gg);
+							uint_fast16_t b = BYTECLIP(yy + bb);
+							*rgb16++ = (fmt16 == JD_FMT_SWAP565)
+								? (r & 0xF8) | g >> 5 | (g & 0x1C) << 11 | (b & 0xF8) << 5	/* GGGBBBBB RRRRRGGG */
+								: (r & 0xF8) << 8 | (g & 0xFC) << 3 | b >> 3;				/* RRRRRGGG GGGBBBBB */
+						} while (++ix & ixshift);
+					}
 				} while (ix & 7);
 				py += 64 - 8;	/* Jump to next block if double block heigt */
 			} while (ix != mx);
@@ -684,12 +722,12 @@ static JRESULT mcu_output (
 		uint8_t *s_, *d;
 		s_ = d = workbuf;
 		for (size_t y_ = 1; y_ < ry; ++y_) {
-			memcpy(d += rx * 3, s_ += mx * 3, rx * 3);	/* Copy effective pixels */
+			memmove(d += rx * bpp, s_ += mx * bpp, rx * bpp);	/* Copy effective pixels (the areas may overlap) */
 		}
 	}
 
-	/* Convert RGB888 to RGB565 if needed */
-	if (JD_FORMAT == 1) {
+	/* Convert RGB888 to RGB565 if it was not built directly */
+	if (jd->format != JD_FMT_RGB888 && !fmt16) {
 		uint8_t *s = workbuf;
 		uint16_t *d = (uint16_t*)s;
 		uint_fast16_t w;
@@ -699,6 +737,7 @@ static JRESULT mcu_output (
 			w = (*s++ & 0xF8) << 8;		/* RRRRR----------- */
 			w |= (*s++ & 0xFC) << 3;	/* -----GGGGGG----- */
 			w |= *s++ >> 3;				/* -----------BBBBB */
+			if (jd->format == JD_FMT_SWAP565) w = (uint16_t)(w << 8 | w >> 8);
 			*d++ = w;
 		} while (--n);
 	}
@@ -759,6 +798,449 @@ static inline uint16_t LDB_WORD(uint8_t* ptr) {
 }
 
 
+/*-----------------------------------------------------------------------*/
+/* Progressive JPEG                                                      */
+/*-----------------------------------------------------------------------*/
+/* All scans are decoded into the coefficient buffer, then the image is   */
+/* output in units of MCU in the same way as the baseline JPEG.           */
+
+static inline int32_t extend (	/* Restore the sign of a coefficient */
+	int32_t v,
+	uint_fast8_t s
+)
+{
+	return (v < (1 << (s - 1))) ? v - (1 << s) + 1 : v;
+}
+
+
+static int16_t* prog_block (	/* Pointer to the coefficients of a block */
+	lgfxJdec* jd,
+	uint_fast8_t cmp,	/* Component number 0:Y, 1:Cb, 2:Cr */
+	uint32_t bx,		/* Block position in the component */
+	uint32_t by
+)
+{
+	uint32_t w = jd->mcux;
+	uint32_t ofs;
+	if (cmp == 0) {
+		ofs = by * w * jd->msx + bx;
+	} else {	/* Cb/Cr blocks follow the Y blocks */
+		ofs = (uint32_t)jd->mcux * jd->mcuy * (jd->msx * jd->msy + cmp - 1) + by * w + bx;
+	}
+	return &jd->coefbuf[ofs << 6];
+}
+
+
+static JRESULT prog_parse_sos (
+	lgfxJdec* jd,
+	const uint8_t* seg,	/* SOS segment data */
+	uint_fast16_t len	/* Size of segment data */
+)
+{
+	uint_fast8_t ns = seg[0];
+	if (ns < 1 || ns > jd->comps_in_frame || len < 4u + 2u * ns) return JDR_FMT1;
+
+	uint_fast8_t ss = seg[1 + 2 * ns];
+	uint_fast8_t se = seg[2 + 2 * ns];
+	uint_fast8_t ah = seg[3 + 2 * ns] >> 4;
+	uint_fast8_t al = seg[3 + 2 * ns] & 15;
+	if (ss == 0) {
+		if (se != 0) return JDR_FMT1;				/* Err: DC and AC in the same scan */
+	} else {
+		if (ns != 1 || se < ss || se > 63) return JDR_FMT1;	/* Err: AC scan must have only one component */
+	}
+	if (al > 13) return JDR_FMT1;
+
+	for (size_t i = 0; i < ns; ++i) {
+		uint_fast8_t c = 0;
+		while (jd->compid[c] != seg[1 + 2 * i]) {	/* Find the component */
+			if (++c == jd->comps_in_frame) return JDR_FMT1;
+		}
+		uint_fast8_t td = seg[2 + 2 * i] >> 4;
+		uint_fast8_t ta = seg[2 + 2 * i] & 15;
+		if (td > 1 || ta > 1) return JDR_FMT3;		/* Err: Supports only table 0 and 1 */
+		if (ah == 0 && !jd->huffbits[ss ? ta : td][ss ? 1 : 0]) return JDR_FMT1;	/* Err: Huffman table not loaded */
+		if (ah != 0 && ss != 0 && !jd->huffbits[ta][1]) return JDR_FMT1;
+		jd->scan_comp[i] = c;
+		jd->scan_td[i] = td;
+		jd->scan_ta[i] = ta;
+	}
+	jd->scan_ncomp = ns;
+	jd->scan_ss = ss;
+	jd->scan_se = se;
+	jd->scan_ah = ah;
+	jd->scan_al = al;
+	return JDR_OK;
+}
+
+
+static JRESULT prog_decode_block (
+	lgfxJdec* jd,
+	int16_t* blk,		/* Coefficients of the block (raster order) */
+	uint_fast8_t sc		/* Index of the component in the scan */
+)
+{
+	int32_t b, d;
+	uint_fast8_t al = jd->scan_al;
+
+	if (jd->scan_ss == 0) {	/* DC scan */
+		if (jd->scan_ah == 0) {	/* First scan */
+			uint_fast8_t id = jd->scan_td[sc];
+			b = huffext(jd, jd->huffbits[id][0], jd->huffcode[id][0], jd->huffdata[id][0]);
+			if (b < 0) return (JRESULT)(-b);
+			d = 0;
+			if (b) {
+				d = bitext(jd, b);
+				if (d < 0) return (JRESULT)(-d);
+				d = extend(d, b);
+			}
+			uint_fast8_t cmp = jd->scan_comp[sc];
+			d += jd->dcv[cmp];
+			jd->dcv[cmp] = d;
+			blk[0] = d * (1 << al);
+		} else {				/* Refinement scan */
+			d = bitext(jd, 1);
+			if (d < 0) return (JRESULT)(-d);
+			if (d) blk[0] |= 1 << al;
+		}
+		return JDR_OK;
+	}
+
+	uint_fast8_t id = jd->scan_ta[sc];
+	const uint8_t* hb = jd->huffbits[id][1];
+	const uint16_t* hc = jd->huffcode[id][1];
+	const uint8_t* hd = jd->huffdata[id][1];
+	uint_fast8_t k = jd->scan_ss;
+	uint_fast8_t se = jd->scan_se;
+
+	if (jd->scan_ah == 0) {	/* AC first scan */
+		if (jd->eobrun) {
+			--jd->eobrun;
+			return JDR_OK;
+		}
+		for (; k <= se; ++k) {
+			b = huffext(jd, hb, hc, hd);
+			if (b < 0) return (JRESULT)(-b);
+			uint_fast8_t r = b >> 4;
+			uint_fast8_t s = b & 15;
+			if (s) {
+				k += r;
+				if (k > 63) return JDR_FMT1;
+				d = bitext(jd, s);
+				if (d < 0) return (JRESULT)(-d);
+				blk[Zig[k]] = extend(d, s) * (1 << al);
+			} else if (r == 15) {	/* ZRL */
+				k += 15;
+			} else {				/* EOBn */
+				uint32_t run = 1u << r;
+				if (r) {
+					d = bitext(jd, r);
+					if (d < 0) return (JRESULT)(-d);
+					run += d;
+				}
+				jd->eobrun = run - 1;
+				break;
+			}
+		}
+		return JDR_OK;
+	}
+
+	/* AC refinement scan */
+	int32_t p1 = 1 << al;
+	int32_t m1 = -p1;
+	if (jd->eobrun == 0) {
+		for (; k <= se; ++k) {
+			b = huffext(jd, hb, hc, hd);
+			if (b < 0) return (JRESULT)(-b);
+			uint_fast8_t r = b >> 4;
+			uint_fast8_t s = b & 15;
+			int32_t v = 0;
+			if (s) {			/* New coefficient (always +1 or -1) */
+				d = bitext(jd, 1);
+				if (d < 0) return (JRESULT)(-d);
+				v = d ? p1 : m1;
+			} else if (r != 15) {	/* EOBn */
+				uint32_t run = 1u << r;
+				if (r) {
+					d = bitext(jd, r);
+					if (d < 0) return (JRESULT)(-d);
+					run += d;
+				}
+				jd->eobrun = run;
+				break;
+			}
+			/* Skip r zero coefficients, appending correction bits to the non-zero ones on the way */
+			do {
+				int16_t* coef = &blk[Zig[k]];
+				if (*coef) {
+					d = bitext(jd, 1);
+					if (d < 0) return (JRESULT)(-d);
+					if (d && (*coef & p1) == 0) *coef += (*coef >= 0) ? p1 : m1;
+				} else {
+					if (r == 0) break;
+					--r;
+				}
+			} while (++k <= se);
+			if (v && k <= se) blk[Zig[k]] = v;
+		}
+	}
+	if (jd->eobrun) {	/* Correction bits for the rest of the band */
+		for (; k <= se; ++k) {
+			int16_t* coef = &blk[Zig[k]];
+			if (*coef) {
+				d = bitext(jd, 1);
+				if (d < 0) return (JRESULT)(-d);
+				if (d && (*coef & p1) == 0) *coef += (*coef >= 0) ? p1 : m1;
+			}
+		}
+		--jd->eobrun;
+	}
+	return JDR_OK;
+}
+
+
+static JRESULT prog_decode_scan (
+	lgfxJdec* jd
+)
+{
+	uint32_t nrst = jd->nrst;
+	uint32_t rst = 0, rsc = 0;
+	JRESULT rc;
+
+	jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;
+	jd->eobrun = 0;
+
+	if (jd->scan_ncomp > 1) {	/* Interleaved scan (DC only) */
+		for (uint32_t my = 0; my < jd->mcuy; ++my) {
+			for (uint32_t mx = 0; mx < jd->mcux; ++mx) {
+				if (nrst && rst++ == nrst) {
+					rc = restart(jd, rsc++);
+					if (rc != JDR_OK) return rc;
+					rst = 1;
+				}
+				for (uint_fast8_t sc = 0; sc < jd->scan_ncomp; ++sc) {
+					uint_fast8_t cmp = jd->scan_comp[sc];
+					if (cmp == 0) {
+						for (uint32_t by = 0; by < jd->msy; ++by) {
+							for (uint32_t bx = 0; bx < jd->msx; ++bx) {
+								rc = prog_decode_block(jd, prog_block(jd, 0, mx * jd->msx + bx, my * jd->msy + by), sc);
+								if (rc != JDR_OK) return rc;
+							}
+						}
+					} else {
+						rc = prog_decode_block(jd, prog_block(jd, cmp, mx, my), sc);
+						if (rc != JDR_OK) return rc;
+					}
+				}
+			}
+		}
+	} else {					/* Non-interleaved scan: the blocks of one component in raster order */
+		uint_fast8_t cmp = jd->scan_comp[0];
+		uint32_t w = jd->width;
+		uint32_t h = jd->height;
+		if (cmp) {
+			w = (w + jd->msx - 1) / jd->msx;
+			h = (h + jd->msy - 1) / jd->msy;
+		}
+		w = (w + 7) >> 3;
+		h = (h + 7) >> 3;
+		for (uint32_t by = 0; by < h; ++by) {
+			for (uint32_t bx = 0; bx < w; ++bx) {
+				if (nrst && rst++ == nrst) {
+					rc = restart(jd, rsc++);
+					if (rc != JDR_OK) return rc;
+					jd->eobrun = 0;
+					rst = 1;
+				}
+				rc = prog_decode_block(jd, prog_block(jd, cmp, bx, by), 0);
+				if (rc != JDR_OK) return rc;
+			}
+		}
+	}
+	return JDR_OK;
+}
+
+
+static int32_t stream_byte (	/* >=0: next byte of the stream, <0: error code */
+	lgfxJdec* jd
+)
+{
+	uint8_t *dp = jd->dptr;
+	if (++dp == jd->dpend) {	/* No input data is available, re-fill input buffer */
+		dp = jd->inbuf;
+		jd->dpend = dp + jd->infunc(jd->device, dp, JD_SZBUF);
+		if (dp == jd->dpend) return 0 - (int32_t)JDR_INP;
+	}
+	jd->dptr = dp;
+	return *dp;
+}
+
+
+static JRESULT stream_read (
+	lgfxJdec* jd,
+	uint8_t* buf,		/* Destination (NULL: skip) */
+	uint_fast16_t len
+)
+{
+	while (len--) {
+		int32_t d = stream_byte(jd);
+		if (d < 0) return (JRESULT)(-d);
+		if (buf) *buf++ = d;
+	}
+	return JDR_OK;
+}
+
+
+static JRESULT prog_next_scan (	/* Process the segments between the scans */
+	lgfxJdec* jd,
+	uint8_t* eoi		/* Set to 1 when EOI is found */
+)
+{
+	uint8_t seg[17 + 256];
+	JRESULT rc;
+	int32_t d;
+
+	for (;;) {
+		do {		/* Find a marker */
+			d = stream_byte(jd);
+			if (d < 0) return (JRESULT)(-d);
+		} while (d != 0xFF);
+		do {
+			d = stream_byte(jd);
+			if (d < 0) return (JRESULT)(-d);
+		} while (d == 0xFF);
+
+		uint_fast8_t marker = d;
+		if (marker == 0xD9) {	/* EOI */
+			*eoi = 1;
+			return JDR_OK;
+		}
+		if (marker == 0 || (marker & 0xF8) == 0xD0) continue;	/* Stuffed byte or RSTn */
+
+		rc = stream_read(jd, seg, 2);
+		if (rc != JDR_OK) return rc;
+		int_fast32_t len = LDB_WORD(seg) - 2;
+		if (len < 0) return JDR_FMT1;
+
+		switch (marker) {
+		case 0xC4:	/* DHT */
+			while (len > 0) {	/* Load the tables one by one */
+				if (len < 17) return JDR_FMT1;
+				rc = stream_read(jd, seg, 17);
+				if (rc != JDR_OK) return rc;
+				uint_fast16_t np = 0;
+				for (size_t i = 1; i < 17; ++i) np += seg[i];
+				if (np > 256 || len < 17 + (int_fast32_t)np) return JDR_FMT1;
+				rc = stream_read(jd, &seg[17], np);
+				if (rc != JDR_OK) return rc;
+				d = create_huffman_tbl(jd, seg, 17 + np);
+				if (d) return (JRESULT)d;
+				len -= 17 + np;
+			}
+			break;
+
+		case 0xDB:	/* DQT */
+			while (len > 0) {
+				if (len < 65) return JDR_FMT1;
+				rc = stream_read(jd, seg, 65);
+				if (rc != JDR_OK) return rc;
+				d = create_qt_tbl(jd, seg, 65);
+				if (d) return (JRESULT)d;
+				len -= 65;
+			}
+			break;
+
+		case 0xDD:	/* DRI */
+			if (len < 2) return JDR_FMT1;
+			rc = stream_read(jd, seg, len);
+			if (rc != JDR_OK) return rc;
+			jd->nrst = LDB_WORD(seg);
+			break;
+
+		case 0xDA:	/* SOS */
+			if (len > 16) return JDR_FMT1;
+			rc = stream_read(jd, seg, len);
+			if (rc != JDR_OK) return rc;
+			jd->dbit = 0;
+			return prog_parse_sos(jd, seg, len);
+
+		default:	/* Skip the segment */
+			rc = stream_read(jd, 0, len);
+			if (rc != JDR_OK) return rc;
+			break;
+		}
+	}
+}
+
+
+static JRESULT prog_output (	/* Output the image from the coefficient buffer */
+	lgfxJdec* jd,
+	uint32_t (*outfunc)(void*, void*, JRECT*)
+)
+{
+	int32_t *tmp = (int32_t*)jd->workbuf;
+	uint32_t nby = jd->msx * jd->msy;
+	uint32_t nbc = jd->comps_in_frame - 1;
+	JRESULT rc;
+
+	for (uint32_t my = 0; my < jd->mcuy; ++my) {
+		for (uint32_t mx = 0; mx < jd->mcux; ++mx) {
+			int16_t *bp = jd->mcubuf;
+			for (uint32_t blk = 0; blk < nby + nbc; ++blk) {
+				uint_fast8_t cmp = (blk < nby) ? 0 : blk - nby + 1;
+				const int16_t* src = (cmp == 0)
+				                   ? prog_block(jd, 0, mx * jd->msx + (blk % jd->msx), my * jd->msy + (blk / jd->msx))
+				                   : prog_block(jd, cmp, mx, my);
+				const int32_t *dqf = jd->qttbl[jd->qtid[cmp]];
+				if (!dqf) return JDR_FMT1;		/* Err: dequantizer table not loaded */
+
+				tmp[0] = src[0] * dqf[0] >> 8;	/* De-quantize, apply scale factor of Arai algorithm and descale 8 bits */
+				int32_t ac = 0;
+				for (size_t i = 1; i < 64; ++i) {
+					ac |= src[i];
+					tmp[i] = src[i] * dqf[i] >> 8;
+				}
+				if (!ac || (JD_USE_SCALE && jd->scale == 3)) {
+					int16_t d = (int16_t)((*tmp >> 8) + 128);	/* Only DC element is used */
+					for (size_t i = 0; i < 64; bp[i++] = d) ;
+				} else {
+					block_idct(tmp, bp);
+				}
+				bp += 64;
+			}
+			rc = mcu_output(jd, outfunc, mx * (jd->msx << 3), my * (jd->msy << 3));
+			if (rc != JDR_OK) return rc;
+		}
+	}
+	return JDR_OK;
+}
+
+
+static JRESULT prog_decomp (
+	lgfxJdec* jd,
+	uint32_t (*outfunc)(void*, void*, JRECT*)
+)
+{
+	JRESULT rc;
+	uint8_t eoi = 0;
+
+	if (!jd->coefbuf) return JDR_MEM1;	/* Err: coefficient buffer is not given */
+	memset(jd->coefbuf, 0, jd->sz_coef);
+
+	do {
+		rc = prog_decode_scan(jd);
+		if (rc != JDR_OK) return rc;
+		rc = prog_next_scan(jd, &eoi);
+		if (rc != JDR_OK) return rc;
+	} while (!eoi);
+
+	return prog_output(jd, outfunc);
+}
+
+
+
+
+
 JRESULT lgfx_jd_prepare (
 	lgfxJdec* jd,			/* Blank decompressor object */
 	uint32_t (*infunc)(void*, uint8_t*, uint32_t),	/* JPEG strem input function */
@@ -780,11 +1262,16 @@ JRESULT lgfx_jd_prepare (
 	jd->infunc = infunc;	/* Stream input function */
 	jd->device = dev;		/* I/O device identifier */
 	jd->nrst = 0;			/* No restart interval (default) */
+	jd->progressive = 0;
+	jd->format = JD_FORMAT;
+	jd->coefbuf = 0;
+	jd->sz_coef = 0;
 
-//	memset(jd->huffbits, 0, sizeof(uint8_t*) * 4);	/* Nulls pointers */
-//	memset(jd->huffcode, 0, sizeof(uint16_t*) * 4);
-//	memset(jd->huffdata, 0, sizeof(uint8_t*) * 4);
-//	memset(jd->qttbl, 0, sizeof(uint32_t*) * 4);
+	memset(jd->huffbits, 0, sizeof(uint8_t*) * 4);	/* Nulls pointers */
+	memset(jd->huffcode, 0, sizeof(uint16_t*) * 4);
+	memset(jd->huffdata, 0, sizeof(uint8_t*) * 4);
+	memset(jd->huffcap, 0, sizeof(uint16_t) * 4);
+	memset(jd->qttbl, 0, sizeof(uint32_t*) * 4);
 
 	jd->inbuf = seg = alloc_pool(jd, JD_SZBUF);		/* Allocate stream input buffer */
 	if (!seg) return JDR_MEM1;
@@ -806,7 +1293,9 @@ JRESULT lgfx_jd_prepare (
 
 		switch (seg[1]) {	/* Marker */
 		case 0xC0:	/* SOF0 (baseline JPEG) */
+		case 0xC2:	/* SOF2 (progressive JPEG) */
 			{/* Load segment data */
+			jd->progressive = (seg[1] == 0xC2);
 			if (len > JD_SZBUF) return JDR_MEM2;
 			if (infunc(dev, seg, len) != len) return JDR_INP;
 
@@ -830,6 +1319,7 @@ JRESULT lgfx_jd_prepare (
 				b = seg[8 + 3 * i];							/* Get dequantizer table ID for this component */
 				if (b > 3) return JDR_FMT3;					/* Err: Invalid ID */
 				jd->qtid[i] = b;
+				jd->compid[i] = seg[6 + 3 * i];				/* Get component identifier referred by SOS */
 			}
 			}
 			break;
@@ -873,6 +1363,11 @@ JRESULT lgfx_jd_prepare (
 
 			if (!jd->width || !jd->height) return JDR_FMT1;	/* Err: Invalid image size */
 
+			if (jd->progressive) {
+				rc = prog_parse_sos(jd, seg, len);			/* The first scan of progressive JPEG */
+				if (rc) return (JRESULT)rc;
+			} else {
+
 			if (seg[0] != jd->comps_in_frame) return JDR_FMT3;	/* Err: Supports only three color or grayscale components format */
 
 			/* Check if all tables corresponding to each components have been loaded */
@@ -887,6 +1382,7 @@ JRESULT lgfx_jd_prepare (
 					return JDR_FMT1;					/* Err: Not loaded */
 				}
 			}
+			}
 
 			/* Allocate working buffer for MCU and RGB */
 			n = jd->msy * jd->msx;						/* Number of Y blocks in the MCU */
@@ -904,6 +1400,15 @@ JRESULT lgfx_jd_prepare (
 				}
 			}
 
+			/* Size of the coefficient buffer for progressive JPEG */
+			jd->mcux = (jd->width  + (jd->msx << 3) - 1) / (jd->msx << 3);
+			jd->mcuy = (jd->height + (jd->msy << 3) - 1) / (jd->msy << 3);
+			if (jd->progressive) {
+				uint64_t sz_coef = (uint64_t)jd->mcux * jd->mcuy * (n + jd->comps_in_frame - 1) * 64 * sizeof(int16_t);
+				if (sz_coef > JD_SZCOEF_MAX) return JDR_MEM1;	/* Err: image too large for the coefficient buffer */
+				jd->sz_coef = (uint32_t)sz_coef;
+			}
+
 			/* Pre-load the JPEG data to extract it from the bit stream */
 			ofs %= JD_SZBUF;						/* Align read offset to JD_SZBUF */
 			int32_t dc = infunc(dev, seg + ofs, JD_SZBUF - ofs);
@@ -915,7 +1420,6 @@ JRESULT lgfx_jd_prepare (
 			return JDR_OK;		/* Initialization succeeded. Ready to decompress the JPEG image. */
 
 		case 0xC1:	/* SOF1 */
-		case 0xC2:	/* SOF2 */
 		case 0xC3:	/* SOF3 */
 		case 0xC5:	/* SOF5 */
 		case 0xC6:	/* SOF6 */
@@ -927,7 +1431,7 @@ JRESULT lgfx_jd_prepare (
 		case 0xCE:	/* SOF14 */
 		case 0xCF:	/* SOF15 */
 		case 0xD9:	/* EOI */
-			return JDR_FMT3;	/* Unsuppoted JPEG standard (may be progressive JPEG) */
+			return JDR_FMT3;	/* Unsuppoted JPEG standard (may be arithmetic coding or lossless JPEG) */
 
 		default:	/* Unknown segment (comment, exif or etc..) */
 			/* Skip segment data */
@@ -959,6 +1463,8 @@ JRESULT lgfx_jd_decomp (
 	if (scale > (JD_USE_SCALE ? 3 : 0)) return JDR_PAR;
 	jd->scale = scale;
 
+	if (jd->progressive) return prog_decomp(jd, outfunc);
+
 	nrst = jd->nrst;
 	mx = jd->msx << 3; my = jd->msy << 3;			/* Size of the MCU (pixel) */
 
@@ -987,3 +1493,56 @@ JRESULT lgfx_jd_decomp (
 
 
 
+
+/*-----------------------------------------------------------------------*/
+/* Decompress a range of restart intervals                               */
+/*-----------------------------------------------------------------------*/
+/* The input stream must be positioned at the top of the entropy-coded  */
+/* data of the interval ri_start (just after its RSTn marker, or just    */
+/* after the SOS segment for the interval 0). The buffered input is      */
+/* discarded, so that the intervals can be decoded by multiple decoder   */
+/* objects each having its own input stream.                             */
+
+JRESULT lgfx_jd_decomp_rst (
+	lgfxJdec* jd,								/* Initialized decompression object (baseline JPEG with restart interval) */
+	uint32_t (*outfunc)(void*, void*, JRECT*),	/* RGB output function */
+	uint_fast8_t scale,							/* Output de-scaling factor (0 to 3) */
+	uint32_t ri_start,							/* First restart interval to decode */
+	uint32_t ri_end								/* Restart interval to stop at (not decoded) */
+)
+{
+	JRESULT rc;
+	uint32_t nrst = jd->nrst;
+	uint32_t total = (uint32_t)jd->mcux * jd->mcuy;
+
+
+	if (scale > (JD_USE_SCALE ? 3 : 0)) return JDR_PAR;
+	if (!nrst || jd->progressive) return JDR_PAR;
+	jd->scale = scale;
+
+	jd->dptr = jd->inbuf;			/* Discard the buffered input, the next read re-fills the buffer */
+	jd->dpend = jd->inbuf + 1;
+	jd->dbit = 0;
+	jd->dcv[2] = jd->dcv[1] = jd->dcv[0] = 0;	/* Initialize DC values */
+
+	uint32_t m = ri_start * nrst;
+	uint32_t end = ri_end * nrst;
+	if (end > total) end = total;
+
+	for (uint32_t rst = 0; m < end; ++m) {
+		if (rst++ == nrst) {	/* Process restart interval */
+			rc = restart(jd, m / nrst - 1);
+			if (rc != JDR_OK) return rc;
+			rst = 1;
+		}
+		rc = mcu_load(jd);
+		if (rc != JDR_OK) return rc;
+		rc = mcu_output(jd, outfunc, (m % jd->mcux) * (jd->msx << 3), (m / jd->mcux) * (jd->msy << 3));
+		if (rc != JDR_OK) return rc;
+	}
+
+	return JDR_OK;
+}
+
+
+
@@ -7,6 +7,9 @@
 / add support grayscale jpeg
 / add bayer pattern
 / tweak for 32bit processor
+/ add progressive JPEG (SOF2) support
+/ add decoding of a range of restart intervals
+/ add runtime selectable RGB565 / byte swapped RGB565 output
 /----------------------------------------------------------------------------*/
 #ifndef __LGFX_TJPGDEC_H__
 #define __LGFX_TJPGDEC_H__
@@ -14,10 +17,11 @@
 /* System Configurations */
 
 #define	JD_SZBUF		512	/* Size of stream input buffer */
-#define JD_FORMAT		0	/* Output pixel format 0:RGB888 (3 BYTE/pix), 1:RGB565 (1 WORD/pix) */
+#define JD_FORMAT		0	/* Default output pixel format 0:RGB888 (3 BYTE/pix), 1:RGB565 (1 WORD/pix), 2:byte swapped RGB565 (1 WORD/pix) */
 #define	JD_USE_SCALE	1	/* Use descaling feature for output */
 #define JD_TBLCLIP		0	/* Use table for saturation (might be a bit faster but increases 1K bytes of code size) */
 #define JD_BAYER		1	/* Use bayer pattern table */
+#define JD_SZCOEF_MAX	(64UL << 20)	/* Upper limit of the coefficient buffer of progressive JPEG (bytes). Larger images are rejected with JDR_MEM1 */
 
 /*---------------------------------------------------------------------------*/
 
@@ -35,6 +39,11 @@ extern "C" {
  typedef long			int32_t;
 #endif
 
+/* Output pixel format (lgfxJdec::format) */
+#define JD_FMT_RGB888	0
+#define JD_FMT_RGB565	1
+#define JD_FMT_SWAP565	2
+
 /* Error code */
 typedef enum {
 	JDR_OK = 0,	/* 0: Succeeded */
@@ -81,6 +90,22 @@ struct lgfxJdec {
 	uint32_t (*infunc)(void*, uint8_t*, uint32_t);/* Pointer to jpeg stream input function */
 	void* device;				/* Pointer to I/O device identifiler for the session */
 	uint8_t comps_in_frame;		/* 1=Y(grayscale)  3=YCrCb */
+	uint8_t compid[3];			/* Component identifier of each component */
+	uint16_t huffcap[2][2];		/* Number of code words the huffman tables can hold [id][dcac] */
+	uint8_t format;				/* Output pixel format JD_FMT_* (set to JD_FORMAT by lgfx_jd_prepare, may be changed before lgfx_jd_decomp) */
+
+	/* Progressive JPEG */
+	uint8_t progressive;		/* 1:Progressive JPEG (SOF2). coefbuf must be set before lgfx_jd_decomp */
+	uint16_t mcux, mcuy;		/* Number of MCUs (horizontal, vertical) */
+	int16_t* coefbuf;			/* DCT coefficients of the whole image (sz_coef bytes, given by the application) */
+	uint32_t sz_coef;			/* Required size of coefbuf (bytes) */
+	uint16_t eobrun;			/* Remaining blocks of the current end-of-band run */
+	uint8_t scan_ncomp;			/* Number of components in the current scan */
+	uint8_t scan_comp[3];		/* Component index of each scan component */
+	uint8_t scan_td[3];			/* DC huffman table ID of each scan component */
+	uint8_t scan_ta[3];			/* AC huffman table ID of each scan component */
+	uint8_t scan_ss, scan_se;	/* Spectral selection (start, end) */
+	uint8_t scan_ah, scan_al;	/* Successive approximation (high, low) */
 };
 
 
@@ -88,6 +113,7 @@ struct lgfxJdec {
 /* TJpgDec API functions */
 JRESULT lgfx_jd_prepare (lgfxJdec*, uint32_t(*)(void*,uint8_t*,uint32_t), void*, uint_fast16_t, void*);
 JRESULT lgfx_jd_decomp (lgfxJdec*, uint32_t(*)(void*,void*,JRECT*), uint_fast8_t);
+JRESULT lgfx_jd_decomp_rst (lgfxJdec*, uint32_t(*)(void*,void*,JRECT*), uint_fast8_t, uint32_t, uint32_t);
 
 
 #ifdef __cplusplus
@@ -17,6 +17,8 @@ Contributors:
 /----------------------------------------------------------------------------*/
 
 #include "LGFXBase.hpp"
+#include "LGFX_TextRunCache.hpp"
+#include "LGFX_PngDecoder.hpp"
 
 #include "../internal/limits.h"
 #include "../utility/lgfx_miniz.h"
@@ -26,12 +28,13 @@ Contributors:
 #include "../utility/lgfx_qoi.h"
 #include "../utility/pgmspace.h"
 #include "panel/Panel_Device.hpp"
+#include "misc/Allocator.hpp"
 #include "misc/bitmap.hpp"
 
 #include <stdarg.h>
 #include <stdint.h>
 #include <math.h>
-#include <list>
+#include <algorithm>
 
 #ifdef min
 #undef min
@@ -299,6 +302,60 @@ namespace lgfx
     endWrite();
   }
 
+  // 同色の矩形を溜めて IPanel::writeFillRectsPreclipped でまとめて送る
+  // Collects same-color rects and submits them to the panel at once.
+  // flush() must be called before endWrite() and before reading back from the panel.
+  struct fill_rect_batch_t
+  {
+    fill_rect_batch_t(IPanel* panel, uint32_t rawcolor, int32_t clip_l, int32_t clip_t, int32_t clip_r, int32_t clip_b)
+    : _panel(panel), _rawcolor(rawcolor), _clip_l(clip_l), _clip_t(clip_t), _clip_r(clip_r), _clip_b(clip_b) {}
+
+    void hline(int32_t x, int32_t y, int32_t w)
+    {
+      if (y < _clip_t || y > _clip_b) return;
+      rect(x, y, w, 1);
+    }
+
+    void rect(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+      if (x < _clip_l) { w += x - _clip_l; x = _clip_l; }
+      if (w > _clip_r + 1 - x) w = _clip_r + 1 - x;
+      if (w < 1) return;
+      if (y < _clip_t) { h += y - _clip_t; y = _clip_t; }
+      if (h > _clip_b + 1 - y) h = _clip_b + 1 - y;
+      if (h < 1) return;
+      add_preclipped(x, y, w, h);
+    }
+
+    void add_preclipped(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+      // shapes emit their upper and lower halves alternately, so look back two entries for a rect to extend
+      for (size_t i = _count, n = 0; i && n < 2; --i, ++n)
+      {
+        auto& r = _rects[i - 1];
+        if (r.x != x || r.w != w) continue;
+        if (r.y + r.h == y) { r.h += h; return; }
+        if (y + h == r.y) { r.y = y; r.h += h; return; }
+      }
+      if (_count == capacity) flush();
+      _rects[_count++] = { (uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h };
+    }
+
+    void flush(void)
+    {
+      if (_count) _panel->writeFillRectsPreclipped(_rects, _count, _rawcolor);
+      _count = 0;
+    }
+
+  private:
+    static constexpr size_t capacity = 32;
+    IPanel* _panel;
+    uint32_t _rawcolor;
+    int32_t _clip_l, _clip_t, _clip_r, _clip_b;
+    size_t _count = 0;
+    fill_rect_t _rects[capacity];
+  };
+
   void LGFXBase::fillCircle(int32_t x, int32_t y, int32_t r) {
     startWrite();
     writeFastHLine(x - r, y, (r << 1) + 1);
@@ -317,6 +374,7 @@ namespace lgfx
     int32_t ddF_x = 1;
     int32_t i     = 0;
 
+    fill_rect_batch_t batch(_panel, _color.raw, _clip_l, _clip_t, _clip_r, _clip_b);
     startWrite();
     do {
       int32_t len = 0;
@@ -328,14 +386,15 @@ namespace lgfx
       f += (ddF_y += 2);
 
       if (corners & 0x1) {
-        if (len) writeFillRect(x - r, y + i - len + 1, (r << 1) + delta, len);
-        writeFastHLine(x - i, y + r, (i << 1) + delta);
+        if (len) batch.rect(x - r, y + i - len + 1, (r << 1) + delta, len);
+        batch.hline(x - i, y + r, (i << 1) + delta);
       }
       if (corners & 0x2) {
-        writeFastHLine(x - i, y - r, (i << 1) + delta);
-        if (len) writeFillRect(x - r, y - i, (r << 1) + delta, len);
+        batch.hline(x - i, y - r, (i << 1) + delta);
+        if (len) batch.rect(x - r, y - i, (r << 1) + delta, len);
       }
     } while (i < --r);
+    batch.flush();
     endWrite();
   }
 
@@ -405,17 +464,18 @@ namespace lgfx
     int32_t ry2 = ry * ry;
     int32_t s;
 
+    fill_rect_batch_t batch(_panel, _color.raw, _clip_l, _clip_t, _clip_r, _clip_b);
     startWrite();
 
-    writeFastHLine(x - rx, y, (rx << 1) + 1);
+    batch.hline(x - rx, y, (rx << 1) + 1);
     i = 0;
     yt = 0;
     xt = rx;
     s = (rx2 << 1) + ry2 * (1 - (rx << 1));
     do {
       while (s < 0) s += rx2 * ((++yt << 2) + 2);
-      writeFillRect(x - xt, y - yt   , (xt << 1) + 1, yt - i);
-      writeFillRect(x - xt, y + i + 1, (xt << 1) + 1, yt - i);
+      batch.rect(x - xt, y - yt   , (xt << 1) + 1, yt - i);
+      batch.rect(x - xt, y + i + 1, (xt << 1) + 1, yt - i);
       i = yt;
       s -= (--xt) * ry2 << 2;
     } while (rx2 * yt <= ry2 * xt);
@@ -425,11 +485,12 @@ namespace lgfx
     s = (ry2 << 1) + rx2 * (1 - (ry << 1));
     do {
       while (s < 0) s += ry2 * ((++xt << 2) + 2);
-      writeFastHLine(x - xt, y - yt, (xt << 1) + 1);
-      writeFastHLine(x - xt, y + yt, (xt << 1) + 1);
+      batch.hline(x - xt, y - yt, (xt << 1) + 1);
+      batch.hline(x - xt, y + yt, (xt << 1) + 1);
       s -= (--yt) * rx2 << 2;
     } while(ry2 * xt <= rx2 * yt);
 
+    batch.flush();
     endWrite();
   }
 
@@ -641,6 +702,7 @@ namespace lgfx
                  + (xstep2 > 0
                    ? std::min(dx2, dy2)
                    : dx2);
+    fill_rect_batch_t batch(_panel, _color.raw, _clip_l, _clip_t, _clip_r, _clip_b);
     startWrite();
     if (y0 != y1) {
       do {
@@ -648,7 +710,7 @@ namespace lgfx
         while (err1 < 0) { err1 += dy1; a += xstep1; }
         err2 -= dx2;
         while (err2 < 0) { err2 += dy2; b += xstep2; }
-        writeFastHLine(a, y0, b - a + 1);
+        batch.hline(a, y0, b - a + 1);
       } while (++y0 < y1);
     }
 
@@ -676,8 +738,9 @@ namespace lgfx
       while (err1 < 0) { err1 += dy1; if ((a += xstep1) == x2) break; }
       err2 -= dx2;
       while (err2 < 0) { err2 += dy2; if ((b += xstep2) == x2) break; }
-      writeFastHLine(a, y0, b - a + 1);
+      batch.hline(a, y0, b - a + 1);
     } while (++y0 <= y2);
+    batch.flush();
     endWrite();
   }
 
@@ -851,6 +914,70 @@ namespace lgfx
     return sqrtf(dx * dx + dy * dy) + h * dr;
   }
 
+  // Helper for draw_gradient_wedgeline()
+  // Finds the x range (relative to a) where a row crosses the convex hull of
+  // the circle at a with radius ra and the circle at b with radius rb.
+  // The per-line terms are prepared once, so each row costs a few multiplications.
+  struct wedge_row_range_t
+  {
+    float bax, bay, ra, rb;
+    float lo_k[3], lo_c[3]; // x >= lo_k * ypay + lo_c
+    float hi_k[3], hi_c[3]; // x <= hi_k * ypay + hi_c
+    float y_min = -INFINITY, y_max = INFINITY; // rows where the body exists
+    uint8_t lo_count = 0, hi_count = 0;
+    bool body = false;
+
+    wedge_row_range_t(float bax_, float bay_, float balen, float ra_, float rb_)
+    : bax(bax_), bay(bay_), ra(ra_), rb(rb_)
+    {
+      float c = (ra - rb) / balen;
+      if (fabsf(c) >= 1.0f) return; // one circle contains the other
+      body = true;
+      float s = sqrtf(1.0f - c * c);
+      float ux = bax / balen, uy = bay / balen;
+      // the body between the outer tangents is where (kx * x + ky * ypay) <= limit for all four
+      add( ux,  uy, balen + rb * c);
+      add(-ux, -uy, -ra * c);
+      add(ux * c - uy * s, uy * c + ux * s, ra);
+      add(ux * c + uy * s, uy * c - ux * s, ra);
+    }
+
+    bool get(float ypay, float* xlo, float* xhi) const
+    {
+      float lo = INFINITY, hi = -INFINITY;
+      // round caps
+      float d = ra * ra - ypay * ypay;
+      if (d > 0.0f) { d = sqrtf(d); lo = -d; hi = d; }
+      float ypby = ypay - bay;
+      d = rb * rb - ypby * ypby;
+      if (d > 0.0f) { d = sqrtf(d); lo = fminf(lo, bax - d); hi = fmaxf(hi, bax + d); }
+      if (body && y_min <= ypay && ypay <= y_max)
+      {
+        float l = -INFINITY, h = INFINITY;
+        for (size_t i = 0; i < lo_count; ++i) { l = fmaxf(l, lo_k[i] * ypay + lo_c[i]); }
+        for (size_t i = 0; i < hi_count; ++i) { h = fminf(h, hi_k[i] * ypay + hi_c[i]); }
+        if (l <= h) { lo = fminf(lo, l); hi = fmaxf(hi, h); }
+      }
+      *xlo = lo;
+      *xhi = hi;
+      return lo <= hi;
+    }
+
+  private:
+    void add(float kx, float ky, float limit)
+    {
+      if (kx == 0.0f)
+      { // horizontal bound: the rows beyond it are outside of the body
+        if      (ky > 0.0f) { y_max = fminf(y_max, limit / ky); }
+        else if (ky < 0.0f) { y_min = fmaxf(y_min, limit / ky); }
+        else if (limit < 0.0f) { body = false; }
+        return;
+      }
+      if (kx > 0.0f) { hi_k[hi_count] = -ky / kx; hi_c[hi_count++] = limit / kx; }
+      else           { lo_k[lo_count] = -ky / kx; lo_c[lo_count++] = limit / kx; }
+    }
+  };
+
   // Helper function for draw_gradient_wedgeline()
   // Constrains coordinates top-left{xlo,ylo}:bottom-right{xhi,yhi} to gfx writable area
   bool LGFXBase::clampArea(int32_t *xlo, int32_t *ylo, int32_t *xhi, int32_t *yhi)
@@ -892,6 +1019,57 @@ namespace lgfx
     return map_gradient( value, start, end, gradient.colors, gradient.count );
   }
 
+  // グラデーションを等間隔に展開したテーブル。画素ごとの map_gradient を固定小数点の参照に置き換える
+  // Number of entries needed for 1 step per 8bit color level in each segment. (up to 1024)
+  static uint32_t gradient_lut_length(const colors_t& gradient)
+  {
+    uint32_t len = (gradient.count - 1) * 255 + 1;
+    return len > 1024 ? 1024 : len;
+  }
+
+  // Expands the gradient into lut[0] (first color) .. lut[length-1] (last color).
+  static void make_gradient_lut(rgb888_t* lut, uint32_t length, const colors_t& gradient)
+  {
+    uint32_t segs = gradient.count - 1;
+    if (length <= 1 || segs == 0) {
+      for (uint32_t i = 0; i < length; ++i) lut[i] = gradient.colors[0];
+      return;
+    }
+    uint32_t last = length - 1;
+    for (uint32_t i = 0; i < length; ++i) {
+      uint32_t pos = ((uint64_t)i * segs << 16) / last; // 16.16 position in the colors array
+      uint32_t idx = pos >> 16;
+      if (idx >= segs) { lut[i] = gradient.colors[segs]; continue; }
+      int32_t frac = pos & 0xFFFF;
+      auto c0 = gradient.colors[idx];
+      auto c1 = gradient.colors[idx + 1];
+      lut[i] = rgb888_t( c0.r + (((c1.r - c0.r) * frac) >> 16)
+                       , c0.g + (((c1.g - c0.g) * frac) >> 16)
+                       , c0.b + (((c1.b - c0.b) * frac) >> 16));
+    }
+  }
+
+  // RGB565 へ 4x4 の組織的ディザで変換する
+  static void dither_to_swap565(swap565_t* dst, const rgb888_t* src, uint32_t len, int32_t x, int32_t y)
+  {
+    static constexpr uint8_t bayer[4][4] =
+    { {  0,  8,  2, 10 }
+    , { 12,  4, 14,  6 }
+    , {  3, 11,  1,  9 }
+    , { 15,  7, 13,  5 }
+    };
+    auto row = bayer[y & 3];
+    for (uint32_t i = 0; i < len; ++i) {
+      uint_fast8_t t = row[(x + i) & 3];
+      auto c = src[i];
+      // r,b lose 3 bits and g loses 2 bits, so the threshold is scaled to each step
+      uint_fast16_t r = c.r + (t >> 1); if (r > 255) r = 255;
+      uint_fast16_t g = c.g + (t >> 2); if (g > 255) g = 255;
+      uint_fast16_t b = c.b + (t >> 1); if (b > 255) b = 255;
+      dst[i] = swap565_t(r, g, b);
+    }
+  }
+
   void LGFXBase::draw_gradient_line( int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t colorstart, uint32_t colorend )
   {
     if ( colorstart == colorend || (x0 == x1 && y0 == y1)) {
@@ -917,19 +1095,21 @@ namespace lgfx
     int32_t dy = abs(y1 - y0);
     int32_t ystep = (y0 < y1) ? 1 : -1;
 
-    int32_t r = (colorstart >> 16)&0xFF;
-    int32_t g = (colorstart >> 8 )&0xFF;
-    int32_t b = (colorstart      )&0xFF;
+    // 16.16 fixed point, offset by 0.5 so that the last pixel gets exactly colorend
+    int32_t r = (colorstart >> 16 & 0xFF) << 16;
+    int32_t g = (colorstart >> 8  & 0xFF) << 16;
+    int32_t b = (colorstart       & 0xFF) << 16;
 
-    int32_t diff_r = ((colorend >> 16)&0xFF) - r;
-    int32_t diff_g = ((colorend >> 8 )&0xFF) - g;
-    int32_t diff_b = ((colorend      )&0xFF) - b;
+    int32_t step_r = (((int32_t)(colorend >> 16 & 0xFF) << 16) - r) / dx;
+    int32_t step_g = (((int32_t)(colorend >> 8  & 0xFF) << 16) - g) / dx;
+    int32_t step_b = (((int32_t)(colorend       & 0xFF) << 16) - b) / dx;
+    r += 0x8000;
+    g += 0x8000;
+    b += 0x8000;
 
     startWrite();
-    for (int32_t x = x0; x <= x1; x++) {
-      setColor(color888( (x - x0) * diff_r / dx + r
-                       , (x - x0) * diff_g / dx + g
-                       , (x - x0) * diff_b / dx + b));
+    for (int32_t x = x0; x <= x1; x++, r += step_r, g += step_g, b += step_b) {
+      setColor(color888(r >> 16, g >> 16, b >> 16));
       if (steep) writePixel(y0, x);
       else       writePixel(x, y0);
       err -= dy;
@@ -968,9 +1148,17 @@ namespace lgfx
     int32_t dy = abs(y1 - y0);
     int32_t ystep = (y0 < y1) ? 1 : -1;
 
+    uint32_t lut_len = gradient_lut_length(gradient);
+    auto lut = (rgb888_t*)alloca(lut_len * sizeof(rgb888_t));
+    make_gradient_lut(lut, lut_len, gradient);
+    // 16.16 fixed point index into the lut, offset by 0.5 so that both ends are exact
+    int32_t step = ((int32_t)(lut_len - 1) << 16) / dx;
+    int32_t index = 0x8000;
+    if (swapped) { index += (lut_len - 1) << 16; step = -step; }
+
     startWrite();
-    for (int32_t x = x0; x <= x1; x++) {
-      auto color = map_gradient( x, swapped?x1:x0, swapped?x0:x1, gradient );
+    for (int32_t x = x0; x <= x1; x++, index += step) {
+      auto color = lut[index >> 16];
       setColor(color888(color.r, color.g, color.b));
       writePixel( steep?y0:x, steep?x:y0 );
       err -= dy;
@@ -988,82 +1176,111 @@ namespace lgfx
     if( !gradient.colors || gradient.count==0 ) return; // line needs at least one color
     if ( (ar < 0.0f) || (br < 0.0f) ) return; // don't negociate with infinity
     if ( (fabsf(ax - bx) < 0.01f) && (fabsf(ay - by) < 0.01f) ) bx += 0.01f; // Avoid divide by zero
-    // convert first gradient color to RGB
-    rgb888_t fg_color = gradient.colors[0];
     // Find line bounding box
     int32_t x0 = (int32_t)floorf(fminf(ax-ar, bx-br));
     int32_t x1 = (int32_t) ceilf(fmaxf(ax+ar, bx+br));
     int32_t y0 = (int32_t)floorf(fminf(ay-ar, by-br));
     int32_t y1 = (int32_t) ceilf(fmaxf(ay+ar, by+br));
-    // clamp coords to drawable area
-    if (!clampArea(&x0, &y0, &x1, &y1)) {
-      return;
-    }
+    // clamp coords to the clip rect (the user's clip rect is kept as is)
+    if (x0 < _clip_l) x0 = _clip_l;
+    if (y0 < _clip_t) y0 = _clip_t;
+    if (x1 > _clip_r) x1 = _clip_r;
+    if (y1 > _clip_b) y1 = _clip_b;
+    if (x0 > x1 || y0 > y1) return;
 
     constexpr float PixelAlphaGain = 255.0f;
 
-    setClipRect( x0, y0, x1, y1 );
-    startWrite();
-
-    // Establish x start and y start
-    int32_t ys = ay;
-    if ((ax-ar)>(bx-br)) ys = by;
-
     float rdt = ar - br; // Radius delta
-    float alpha = 1.0f; // base alpha
+    float rin = fminf(ar, br) + 0.5f - HiAlphaTheshold - 0.01f; // pixels nearer than this to the a to b segment are opaque
     ar += 0.5f; // center pixel
     // line distance including rounded edges
     float linedist = is_circle? (ar + br)*.5f : pixelDistance(ax, ay, bx, by) + ar + br;
-    float xpax, ypay, bax = bx - ax, bay = by - ay;
-
-    int32_t xs = x0; // Set x start to left side of box
-    // 1st pass: Scan bounding box from ys down, calculate pixel intensity from distance to line
-    for (int32_t yp = ys; yp <= y1; yp++) {
-      bool endX = false; // Flag to skip pixels
-      ypay = yp - ay;
-      for (int32_t xp = xs; xp <= x1; xp++) {
-        if (endX) if (alpha <= LoAlphaTheshold) break;  // Skip right side
-        xpax = xp - ax;
-        alpha = ar - wedgeLineDistance(xpax, ypay, bax, bay, rdt);
-        if (alpha <= LoAlphaTheshold ) continue;
-        // handle gradient
-        if( gradient.count>1 ) fg_color = map_gradient( pixelDistance(ax, ay, xp, yp), 0.0f, linedist, gradient );
-        // Track edge to minimise calculations
-        if (!endX) { endX = true; xs = xp; }
-        if (alpha > HiAlphaTheshold) {
-          setColor(color888(fg_color.r, fg_color.g, fg_color.b));
-          drawPixel(xp, yp);
-          continue;
+    float bax = bx - ax, bay = by - ay;
+    float balen = sqrtf(bax * bax + bay * bay);
+    wedge_row_range_t outer(bax, bay, balen, ar, br + 0.5f);
+    wedge_row_range_t inner(bax, bay, balen, rin, rin);
+
+    // 1行分のカバレッジと色を保持するバッファ。半透明の区間はまとめて合成し、不透明の区間は同色ごとに塗り潰す
+    // One row of coverage and color. Translucent runs are blended with one writeImageARGB call,
+    // opaque runs are filled per color.
+    auto buffer = (argb8888_t*)alloca((x1 - x0 + 1) * sizeof(argb8888_t));
+    pixelcopy_t pc_blend = create_pc_blend();
+
+    rgb888_t* lut = nullptr;
+    uint32_t lut_last = 0;
+    float lut_scale = 0.0f;
+    if (gradient.count > 1) {
+      uint32_t lut_len = gradient_lut_length(gradient);
+      lut = (rgb888_t*)alloca(lut_len * sizeof(rgb888_t));
+      make_gradient_lut(lut, lut_len, gradient);
+      lut_last = lut_len - 1;
+      lut_scale = lut_last / linedist;
+    }
+
+    rgb888_t fg_color = gradient.colors[0];
+    uint32_t solid_rgb = color888(fg_color.r, fg_color.g, fg_color.b);
+    uint32_t solid_raw = _write_conv.convert(solid_rgb);
+
+    startWrite();
+    for (int32_t yp = y0; yp <= y1; yp++) {
+      float ypay = yp - ay;
+      float lo, hi;
+      if (!outer.get(ypay, &lo, &hi)) continue;
+      int32_t xs = std::max(x0, (int32_t)floorf(ax + lo));
+      int32_t xe = std::min(x1, (int32_t) ceilf(ax + hi));
+
+      // 単色の場合、内側の不透明な区間は距離を計算せずに埋める
+      int32_t is = xe + 1, ie = xe;
+      if (gradient.count == 1 && rin > 0.0f && inner.get(ypay, &lo, &hi)) {
+        is = std::max(xs, (int32_t) ceilf(ax + lo));
+        ie = std::min(xe, (int32_t)floorf(ax + hi));
+        if (is > ie) { is = xe + 1; ie = xe; }
+        else {
+          uint32_t argb = solid_rgb | 0xFF000000u;
+          for (int32_t xp = is; xp <= ie; xp++) { buffer[xp - x0].raw = argb; }
         }
-        fillRectAlpha(xp, yp, 1, 1, (uint8_t)(alpha * PixelAlphaGain), fg_color);
       }
-    }
 
-    xs = x0; // Reset x start to left side of box
-    // 2nd pass: Scan bounding box from ys-1 up, calculate pixel intensity from distance to line
-    for (int32_t yp = ys-1; yp >= y0; yp--) {
-      bool endX = false; // Flag to skip pixels
-      ypay = yp - ay;
-      for (int32_t xp = xs; xp <= x1; xp++) {
-        if (endX) if (alpha <= LoAlphaTheshold) break;  // Skip right side of drawn line
-        xpax = xp - ax;
-        alpha = ar - wedgeLineDistance(xpax, ypay, bax, bay, rdt);
-        if (alpha <= LoAlphaTheshold ) continue;
+      // calculate pixel intensity from distance to line
+      for (int32_t xp = xs; xp <= xe; xp++) {
+        if (xp == is) { xp = ie; continue; }
+        float alpha = ar - wedgeLineDistance(xp - ax, ypay, bax, bay, rdt);
+        auto& px = buffer[xp - x0];
+        if (alpha <= LoAlphaTheshold) { px.raw = 0; continue; }
         // handle gradient
-        if( gradient.count>1 ) fg_color = map_gradient( pixelDistance(ax, ay, xp, yp), 0.0f, linedist, gradient );
-        // Track line boundary
-        if (!endX) { endX = true; xs = xp; }
-        if (alpha > HiAlphaTheshold) {
-          setColor(color888(fg_color.r, fg_color.g, fg_color.b));
-          drawPixel(xp, yp);
+        if (lut) {
+          uint32_t index = pixelDistance(ax, ay, xp, yp) * lut_scale;
+          fg_color = lut[index < lut_last ? index : lut_last];
+        }
+        px.set(alpha > HiAlphaTheshold ? 255 : (uint8_t)(alpha * PixelAlphaGain), fg_color.r, fg_color.g, fg_color.b);
+      }
+
+      int32_t xp = xs;
+      while (xp <= xe) {
+        auto a = buffer[xp - x0].a;
+        int32_t run = xp;
+        if (a == 0) {
+          while (++xp <= xe && buffer[xp - x0].a == 0);
+          continue;
+        }
+        if (a == 255) {
+          uint32_t rgb = buffer[xp - x0].raw & 0xFFFFFF;
+          while (++xp <= xe && buffer[xp - x0].raw == (rgb | 0xFF000000u));
+          uint32_t raw = (gradient.count > 1) ? _write_conv.convert(rgb) : solid_raw;
+          _panel->writeFillRectPreclipped(run, yp, xp - run, 1, raw);
           continue;
         }
-        fillRectAlpha(xp, yp, 1, 1, (uint8_t)(alpha * PixelAlphaGain), fg_color);
+        while (++xp <= xe && (uint8_t)(buffer[xp - x0].a - 1) < 254);
+        // the panel may rewrite the steps for its rotation, so set them for each run
+        pc_blend.src_data = &buffer[run - x0];
+        pc_blend.src_x32_add = 1 << pixelcopy_t::FP_SCALE;
+        pc_blend.src_y32_add = 0;
+        pc_blend.src_x32 = 0;
+        pc_blend.src_y32 = 0;
+        _panel->writeImageARGB(run, yp, xp - run, 1, &pc_blend);
       }
     }
-
     endWrite();
-    clearClipRect();
   }
 
   void LGFXBase::draw_wedgeline(float ax, float ay, float bx, float by, float ar, float br, const uint32_t fg_color)
@@ -1090,17 +1307,34 @@ namespace lgfx
       float fmidy  = midy*hratio;
       float hyp0   = pixelDistance( midx, midy, 0, 0 );
 
+      uint32_t lut_len = gradient_lut_length(gradient);
+      auto lut = (rgb888_t*)alloca(lut_len * sizeof(rgb888_t));
+      make_gradient_lut(lut, lut_len, gradient);
+      uint32_t lut_last = lut_len - 1;
+      float lut_scale = lut_last / hyp0;
+
+      bool dither = _gradient_dither && getColorDepth() == rgb565_2Byte;
       rgb888_t scanline[w];
+      swap565_t* dithered = dither ? (swap565_t*)alloca(w * sizeof(swap565_t)) : nullptr;
 
       startWrite();
-      for( int _y=0;_y<h;_y++ ) {
+      // the upper and lower halves are mirrored, so each scanline is pushed twice
+      for( int _y=0;_y<(h+1)/2;_y++ ) {
         // only half of the scan line needs to be calculated, the other half is mirrored
         for( int _x=0;_x<=w/2;_x++ ) {
-          auto distance       = pixelDistance( fmidx, fmidy, _x*vratio, _y*hratio );
-          scanline[_x]        = map_gradient( distance, 0, hyp0, gradient );
+          uint32_t index      = pixelDistance( fmidx, fmidy, _x*vratio, _y*hratio ) * lut_scale;
+          scanline[_x]        = lut[index < lut_last ? index : lut_last];
           scanline[(w-1)-_x]  = scanline[_x];
         }
-        pushImage( x, _y+y, w, 1, scanline );
+        int ys[2] = { _y, (int)(h-1)-_y };
+        for (int i = 0; i < (ys[0] == ys[1] ? 1 : 2); ++i) {
+          if (dither) {
+            dither_to_swap565(dithered, scanline, w, x, y+ys[i]);
+            pushImage( x, y+ys[i], w, 1, dithered );
+          } else {
+            pushImage( x, y+ys[i], w, 1, scanline );
+          }
+        }
       }
       endWrite();
   }
@@ -1114,18 +1348,28 @@ namespace lgfx
 
   void LGFXBase::fill_rect_linear_gradient(int32_t x, int32_t y, uint32_t w, uint32_t h, const colors_t gradient, fill_style_t style )
   {
-    if( !gradient.colors || gradient.count==0 ) return;
+    if( !gradient.colors || gradient.count==0 || w==0 || h==0 ) return;
     bool is_vertical = style==VLINEAR;
     const uint32_t gradient_len = is_vertical ? h : w;
     rgb888_t scanline[gradient_len];
-    for(int i=0;i<gradient_len;i++) { // memoize one gradient scanline
-      scanline[i] = map_gradient( i, 0, gradient_len, gradient );
-    }
+    make_gradient_lut(scanline, gradient_len, gradient); // memoize one gradient scanline
+    bool dither = _gradient_dither && getColorDepth() == rgb565_2Byte;
+    swap565_t* dithered = dither ? (swap565_t*)alloca(w * sizeof(swap565_t)) : nullptr;
+    rgb888_t* solid = (dither && is_vertical) ? (rgb888_t*)alloca(w * sizeof(rgb888_t)) : nullptr;
     startWrite();
     for( int ys=0;ys<h;ys++ ) {
       if( is_vertical ) { // scanline is used as an colors index
+        if (dither) {
+          for (uint32_t i = 0; i < w; ++i) solid[i] = scanline[ys];
+          dither_to_swap565(dithered, solid, w, x, y+ys);
+          pushImage( x, y+ys, w, 1, dithered );
+          continue;
+        }
         setColor(color888(scanline[ys].r, scanline[ys].g, scanline[ys].b));
         drawFastHLine( x, y+ys, w );
+      } else if (dither) {
+        dither_to_swap565(dithered, scanline, w, x, y+ys);
+        pushImage( x, y+ys, w, 1, dithered );
       } else { // scanline is used as a line buffer
         pushImage( x, y+ys, w, 1, scanline );
       }
@@ -1195,6 +1439,302 @@ namespace lgfx
     endWrite();
   }
 
+  // 多角形の辺テーブル。座標は 16.16 の固定小数点で、走査線ごとに交差する辺を x 順に並べる
+  // Active edge table for fillPolygon / fillSmoothPolygon. Coordinates are 16.16 fixed point.
+  struct polygon_edge_t
+  {
+    int32_t y0, y1;   // y0 < y1, the edge covers scanlines y0 <= y < y1
+    int32_t x0;
+    int64_t dxdy;     // 16.16, can exceed 32 bits for nearly horizontal edges
+    int32_t x;        // crossing of the current scanline
+    int32_t dir;      // +1: downward, -1: upward (for the non-zero rule)
+  };
+
+  struct polygon_scanner_t
+  {
+    // 16.16 で差分が 32bit に収まる範囲。これを超える頂点を持つ辺は描画範囲の周囲で切り取る
+    // Edges with a vertex beyond +-coord_limit pixels are cut around the clip rect, so that
+    // 16.16 coordinates and their differences fit in 32 bits.
+    static constexpr int32_t coord_limit = 0x3FFF;
+    double guard_l, guard_t, guard_r, guard_b;
+
+    polygon_edge_t* edges = nullptr;
+    polygon_edge_t** active = nullptr;
+    size_t edge_count = 0;
+    size_t active_count = 0;
+    size_t next_edge = 0;
+    int32_t ymin = INT32_MAX, ymax = INT32_MIN;
+    int32_t xmin = INT32_MAX, xmax = INT32_MIN;
+
+    ~polygon_scanner_t(void) { if (edges) heap_free(edges); }
+
+    template <typename T>
+    static bool in_range(T v) { return v >= -coord_limit && v <= coord_limit; }
+    static int32_t to_fixed(int32_t v) { return v * 65536; }
+    static int32_t to_fixed(float v) { return v * 65536.0f; }
+
+    // get(i, &x, &y) returns the i-th vertex in pixels. Only pixels within the clip rect are scanned.
+    template <typename T, typename TGet>
+    bool setup(size_t count, TGet get, int32_t clip_l, int32_t clip_t, int32_t clip_r, int32_t clip_b)
+    {
+      if (count < 3) return false;
+      guard_l = std::max(clip_l - 2, -coord_limit);
+      guard_t = std::max(clip_t - 2, -coord_limit);
+      guard_r = std::min(clip_r + 2,  coord_limit);
+      guard_b = std::min(clip_b + 2,  coord_limit);
+      // 範囲外の頂点を持つ辺は最大3本に分割される
+      // An edge with a vertex out of range is split into up to 3 edges.
+      size_t capacity = count;
+      for (size_t i = 0; i < count; ++i)
+      {
+        T x, y;
+        get(i, &x, &y);
+        if (!in_range(x) || !in_range(y)) { capacity = count * 3; break; }
+      }
+      edges = (polygon_edge_t*)heap_alloc(capacity * (sizeof(polygon_edge_t) + sizeof(polygon_edge_t*)));
+      if (!edges) return false;
+      active = (polygon_edge_t**)&edges[capacity];
+      T px, py;
+      get(count - 1, &px, &py);
+      for (size_t i = 0; i < count; ++i)
+      {
+        T x, y;
+        get(i, &x, &y);
+        if (in_range(px) && in_range(py) && in_range(x) && in_range(y))
+        {
+          add_edge(to_fixed(px), to_fixed(py), to_fixed(x), to_fixed(y));
+        }
+        else
+        {
+          add_clipped_edge(px, py, x, y);
+        }
+        px = x;
+        py = y;
+      }
+      std::sort(edges, edges + edge_count, [](const polygon_edge_t& a, const polygon_edge_t& b) { return a.y0 < b.y0; });
+      return edge_count != 0;
+    }
+
+    void add_edge(int32_t px, int32_t py, int32_t x, int32_t y)
+    {
+      if (xmin > px) xmin = px;
+      if (xmax < px) xmax = px;
+      if (xmin > x) xmin = x;
+      if (xmax < x) xmax = x;
+      if (py == y) return; // horizontal edges never cross a scanline
+      auto e = &edges[edge_count++];
+      bool down = py < y;
+      e->dir = down ? 1 : -1;
+      e->y0 = down ? py : y;
+      e->y1 = down ? y : py;
+      e->x0 = down ? px : x;
+      e->dxdy = (((int64_t)(down ? x - px : px - x)) << 16) / (e->y1 - e->y0);
+      if (ymin > e->y0) ymin = e->y0;
+      if (ymax < e->y1) ymax = e->y1;
+    }
+
+    // 描画範囲外へはみ出す辺を上下は切り捨て、左右は範囲の端に沿わせる。各走査線の巻き数は変わらない
+    // Cuts an edge to the guard box around the clip rect. Rows outside the box are dropped and the
+    // parts left or right of it run along its side, so the winding of every scanline inside is unchanged.
+    void add_clipped_edge(double x0, double y0, double x1, double y1)
+    {
+      bool down = y0 < y1;
+      if (!down)
+      {
+        if (!(y0 > y1)) return; // horizontal or NaN
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+      }
+      if (y1 <= guard_t || y0 >= guard_b) return;
+      double dxdy = (x1 - x0) / (y1 - y0);
+      if (y0 < guard_t) { x0 += (guard_t - y0) * dxdy; y0 = guard_t; }
+      if (y1 > guard_b) { x1 -= (y1 - guard_b) * dxdy; y1 = guard_b; }
+
+      double ys[4] = { y0, 0, 0, y1 };
+      size_t n = 1;
+      if (x0 != x1)
+      {
+        double ya = y0 + (guard_l - x0) / dxdy;
+        double yb = y0 + (guard_r - x0) / dxdy;
+        if (ya > yb) std::swap(ya, yb);
+        if (ya > y0 && ya < y1) ys[n++] = ya;
+        if (yb > y0 && yb < y1) ys[n++] = yb;
+      }
+      ys[n++] = y1;
+
+      auto x_at = [&](double y) { return std::min(guard_r, std::max(guard_l, x0 + (y - y0) * dxdy)); };
+      for (size_t i = 1; i < n; ++i)
+      {
+        int32_t xa = x_at(ys[i - 1]) * 65536.0;
+        int32_t ya = ys[i - 1] * 65536.0;
+        int32_t xb = x_at(ys[i]) * 65536.0;
+        int32_t yb = ys[i] * 65536.0;
+        if (down) add_edge(xa, ya, xb, yb);
+        else      add_edge(xb, yb, xa, ya);
+      }
+    }
+
+    // Updates the active edges for the scanline at sy, which must not decrease between calls.
+    size_t scan(int32_t sy)
+    {
+      size_t n = 0;
+      for (size_t i = 0; i < active_count; ++i)
+      {
+        if (active[i]->y1 > sy) active[n++] = active[i];
+      }
+      while (next_edge < edge_count && edges[next_edge].y0 <= sy)
+      {
+        auto e = &edges[next_edge++];
+        if (e->y1 > sy) active[n++] = e;
+      }
+      active_count = n;
+      for (size_t i = 0; i < n; ++i)
+      { // insertion sort by x, the order rarely changes between scanlines
+        auto e = active[i];
+        e->x = e->x0 + (int32_t)(((int64_t)(sy - e->y0) * e->dxdy) >> 16);
+        size_t j = i;
+        for (; j && active[j - 1]->x > e->x; --j) active[j] = active[j - 1];
+        active[j] = e;
+      }
+      return n;
+    }
+
+    // Calls fn(x_enter, x_exit) for each inside span of the current scanline.
+    template <typename TFunc>
+    void spans(fill_rule_t rule, TFunc fn) const
+    {
+      int32_t wind = 0;
+      int32_t xs = 0;
+      for (size_t i = 0; i < active_count; ++i)
+      {
+        auto e = active[i];
+        bool was_inside = (rule == evenodd) ? (wind & 1) : (wind != 0);
+        wind += e->dir;
+        bool inside = (rule == evenodd) ? (wind & 1) : (wind != 0);
+        if (inside == was_inside) continue;
+        if (inside) xs = e->x;
+        else if (xs < e->x) fn(xs, e->x);
+      }
+    }
+  };
+
+  void LGFXBase::fillPolygon(const point_t* points, size_t count, fill_rule_t rule)
+  {
+    polygon_scanner_t scanner;
+    if (!scanner.setup<int32_t>(count, [points](size_t i, int32_t* x, int32_t* y) { *x = points[i].x; *y = points[i].y; }, _clip_l, _clip_t, _clip_r, _clip_b)) return;
+
+    int32_t y  = std::max(_clip_t, (scanner.ymin + 0xFFFF) >> 16);
+    int32_t ye = std::min(_clip_b, ((scanner.ymax + 0xFFFF) >> 16) - 1);
+    fill_rect_batch_t batch(_panel, _color.raw, _clip_l, _clip_t, _clip_r, _clip_b);
+    startWrite();
+    for (; y <= ye; ++y)
+    {
+      scanner.scan(y << 16);
+      scanner.spans(rule, [&batch, y](int32_t xa, int32_t xb)
+      {
+        int32_t xs = (xa + 0xFFFF) >> 16;
+        int32_t xe = (xb + 0xFFFF) >> 16;
+        if (xs < xe) batch.hline(xs, y, xe - xs);
+      });
+    }
+    batch.flush();
+    endWrite();
+  }
+
+  void LGFXBase::fillSmoothPolygon(const pointf_t* points, size_t count, fill_rule_t rule)
+  {
+    polygon_scanner_t scanner;
+    if (!scanner.setup<float>(count, [points](size_t i, float* x, float* y) { *x = points[i].x; *y = points[i].y; }, _clip_l, _clip_t, _clip_r, _clip_b)) return;
+
+    // 1画素を縦4本の走査線で標本化し、横方向は 1/256 画素単位の被覆率を加算する
+    // Each row is sampled with 4 scanlines, with horizontal coverage in 1/256 pixel.
+    static constexpr int sub_shift = 2;
+    static constexpr int32_t sub_count = 1 << sub_shift;
+
+    int32_t x0 = std::max(_clip_l, (scanner.xmin + 0x8000) >> 16);
+    int32_t x1 = std::min(_clip_r, (scanner.xmax + 0x8000) >> 16);
+    int32_t y  = std::max(_clip_t, (scanner.ymin + 0x8000) >> 16);
+    int32_t ye = std::min(_clip_b, (scanner.ymax + 0x8000) >> 16);
+    if (x0 > x1 || y > ye) return;
+
+    int32_t w = x1 - x0 + 1;
+    // cover: coverage of the pixels at the span ends, inner: +-256 at the ends of the fully covered pixels
+    auto cover  = (uint16_t*)alloca((w + 1) * sizeof(uint16_t));
+    auto inner  = (int16_t*)alloca((w + 1) * sizeof(int16_t));
+    auto buffer = (argb8888_t*)alloca(w * sizeof(argb8888_t));
+    memset(cover, 0, (w + 1) * sizeof(uint16_t));
+    memset(inner, 0, (w + 1) * sizeof(int16_t));
+    pixelcopy_t pc_blend = create_pc_blend();
+    uint32_t rgb888 = _write_conv.revert_rgb888(_color.raw);
+
+    // span limits in 24.8, relative to the left edge of pixel x0
+    int32_t lim_l = 0;
+    int32_t lim_r = w << 8;
+
+    startWrite();
+    for (; y <= ye; ++y)
+    {
+      int32_t dirty_l = w, dirty_r = -1;
+      for (int32_t k = 0; k < sub_count; ++k)
+      {
+        int32_t sy = (y << 16) - 0x8000 + ((2 * k + 1) << (15 - sub_shift));
+        if (sy < scanner.ymin) continue;
+        if (sy >= scanner.ymax) break;
+        scanner.scan(sy);
+        scanner.spans(rule, [&](int32_t xa, int32_t xb)
+        {
+          xa = ((xa + 0x8000) >> 8) - (x0 << 8);
+          xb = ((xb + 0x8000) >> 8) - (x0 << 8);
+          if (xa < lim_l) xa = lim_l;
+          if (xb > lim_r) xb = lim_r;
+          if (xa >= xb) return;
+          int32_t ia = xa >> 8;
+          int32_t ib = xb >> 8;
+          if (dirty_l > ia) dirty_l = ia;
+          if (dirty_r < ib) dirty_r = ib;
+          if (ia == ib) { cover[ia] += xb - xa; return; }
+          cover[ia] += 256 - (xa & 255);
+          inner[ia + 1] += 256;
+          inner[ib] -= 256;
+          cover[ib] += xb & 255; // cover[w] and inner[w] are guards for xb == lim_r
+        });
+      }
+      if (dirty_r >= w) dirty_r = w - 1;
+      for (int32_t i = dirty_l, acc = 0; i <= dirty_r + 1; ++i)
+      {
+        acc += inner[i];
+        inner[i] = 0;
+        cover[i] += acc;
+      }
+
+      int32_t i = dirty_l;
+      while (i <= dirty_r)
+      {
+        int32_t run = i;
+        uint32_t c = cover[i];
+        if (c == 0) { while (++i <= dirty_r && cover[i] == 0); continue; }
+        if (c >= (uint32_t)(255 << sub_shift)) {
+          while (++i <= dirty_r && cover[i] >= (uint32_t)(255 << sub_shift));
+          _panel->writeFillRectPreclipped(x0 + run, y, i - run, 1, _color.raw);
+          continue;
+        }
+        do {
+          buffer[i].set(c >> sub_shift, rgb888 >> 16, rgb888 >> 8, rgb888);
+          c = cover[++i];
+        } while (i <= dirty_r && c && c < (uint32_t)(255 << sub_shift));
+        // the panel may rewrite the steps for its rotation, so set them for each run
+        pc_blend.src_data = &buffer[run];
+        pc_blend.src_x32_add = 1 << pixelcopy_t::FP_SCALE;
+        pc_blend.src_y32_add = 0;
+        pc_blend.src_x32 = 0;
+        pc_blend.src_y32 = 0;
+        _panel->writeImageARGB(x0 + run, y, i - run, 1, &pc_blend);
+      }
+      if (dirty_l <= dirty_r + 1) memset(&cover[dirty_l], 0, (dirty_r - dirty_l + 2) * sizeof(uint16_t));
+    }
+    endWrite();
+  }
+
   void LGFXBase::drawEllipseArc(int32_t x, int32_t y, int32_t r0x, int32_t r1x, int32_t r0y, int32_t r1y, float start, float end)
   {
     if (r0x < r1x) std::swap(r0x, r1x);
@@ -1276,6 +1816,7 @@ namespace lgfx
     int32_t oradius_x2 = oradius_x * (oradius_x + 1);
     float orad_rate = oradius_x2 && oradius_y2 ? (float)oradius_x2 / (float)oradius_y2 : 0;
 
+    fill_rect_batch_t batch(_panel, _color.raw, _clip_l, _clip_t, _clip_r, _clip_b);
     do
     {
       int32_t y2 = y * y;
@@ -1310,7 +1851,7 @@ namespace lgfx
         {
           if (len)
           {
-            writeFastHLine(cx + x - len, cy + y, len);
+            batch.hline(cx + x - len, cy + y, len);
             len = 0;
           }
           if (x2 >= compare_o) break;
@@ -1318,6 +1859,7 @@ namespace lgfx
         }
       } while (++x <= xe);
     } while (++y <= ye);
+    batch.flush();
   }
 
   void LGFXBase::draw_bitmap(int32_t x, int32_t y, const uint8_t *bitmap, int32_t w, int32_t h, uint32_t fg_rawcolor, uint32_t bg_rawcolor)
@@ -1441,6 +1983,24 @@ namespace lgfx
     endWrite();
   }
 
+  void LGFXBase::pushImageRegion(int32_t x, int32_t y, int32_t w, int32_t h, int32_t src_x, int32_t src_y, pixelcopy_t *param, bool use_dma)
+  {
+    int32_t dx=0, dw=w;
+    if (0 < _clip_l - x) { dx = _clip_l - x; dw -= dx; x = _clip_l; }
+
+    if (_adjust_width(x, dx, dw, _clip_l, _clip_r - _clip_l + 1)) return;
+    param->src_x32 = (src_x << pixelcopy_t::FP_SCALE) + param->src_x32_add * dx;
+
+    int32_t dy=0, dh=h;
+    if (0 < _clip_t - y) { dy = _clip_t - y; dh -= dy; y = _clip_t; }
+    if (_adjust_width(y, dy, dh, _clip_t, _clip_b - _clip_t + 1)) return;
+    param->src_y32 = (src_y + dy) << pixelcopy_t::FP_SCALE;
+
+    startWrite();
+    _panel->writeImage(x, y, dw, dh, param, use_dma);
+    endWrite();
+  }
+
   void LGFXBase::pushAlphaImage(int32_t x, int32_t y, int32_t w, int32_t h, pixelcopy_t *param)
   {
     uint32_t x_mask = 7 >> (param->src_bits >> 1);
@@ -1520,6 +2080,12 @@ namespace lgfx
     pc->src_width = w;
     uint32_t x_mask = 7 >> (pc->src_bits >> 1);
     pc->src_bitwidth = (w + x_mask) & (~x_mask);
+    pixelcopy_t pc_post = create_pc_blend();
+    push_image_affine_aa(matrix, pc, &pc_post);
+  }
+
+  pixelcopy_t LGFXBase::create_pc_blend(void)
+  {
     pixelcopy_t pc_post;
     auto dst_depth = getColorDepth();
     pc_post.dst_bits = _write_conv.bits;
@@ -1542,7 +2108,7 @@ namespace lgfx
         pc_post.fp_copy = pixelcopy_t::blend_rgb_fast<rgb332_t, argb8888_t>;
       }
     }
-    push_image_affine_aa(matrix, pc, &pc_post);
+    return pc_post;
   }
 
   void LGFXBase::fillAffine(const float matrix[6], int32_t w, int32_t h)
@@ -1844,28 +2410,103 @@ namespace lgfx
     _panel->readRect(x, y, w, h, dst, param);
   }
 
-  struct paint_point_t { int32_t lx,rx,y,oy; };
+  // 塗り潰し待ちの区間。y の行を走査し、dy は親の行から見た進行方向。
+  struct paint_span_t { int32_t lx, rx, y, dy; };
 
-  static void paint_add_points(std::list<paint_point_t>& points, int32_t lx, int32_t rx, int32_t y, int32_t oy, uint8_t* linebuf)
+  // ノード毎の確保を避けるため、区間は一塊の領域にスタックとして積む。
+  // 容量が足りなくなった時のみ倍の大きさに確保し直す。
+  struct paint_span_stack_t
   {
-    paint_point_t pt { 0, 0, y, oy };
-    do
+    paint_span_t* spans = nullptr;
+    size_t count = 0;
+    size_t capacity = 0;
+
+    ~paint_span_stack_t(void) { if (spans) heap_free(spans); }
+
+    bool push(int32_t lx, int32_t rx, int32_t y, int32_t dy)
     {
-      while (lx < rx && !linebuf[lx]) ++lx;
-      if (!linebuf[lx]) break;
-      pt.lx = lx;
-      while (++lx <= rx && linebuf[lx]);
-      pt.rx = lx - 1;
-      points.emplace_back(pt);
-    } while (lx <= rx);
-  }
+      if (count == capacity)
+      {
+        size_t newcap = capacity ? capacity << 1 : 256;
+        auto newspans = (paint_span_t*)heap_alloc(newcap * sizeof(paint_span_t));
+        if (newspans == nullptr) { return false; }
+        if (spans)
+        {
+          memcpy(newspans, spans, count * sizeof(paint_span_t));
+          heap_free(spans);
+        }
+        spans = newspans;
+        capacity = newcap;
+      }
+      spans[count++] = { lx, rx, y, dy };
+      return true;
+    }
+  };
+
+  // 塗り潰し対象の判定結果を行単位で保持するキャッシュ。
+  // 少ない行数から始め、行の追い出しが起きた時に倍の行数へ拡げる。
+  // このため確保量は塗り潰しが到達した行の範囲に応じた大きさで済む。
+  // 拡げられない場合は追い出された行を必要になった時に読み直す。
+  // 塗り終えた画素は対象色と異なるため、読み直しても結果は変わらない。
+  struct paint_row_cache_t
+  {
+    uint8_t* rows = nullptr;
+    int32_t* tags = nullptr;
+    int32_t slots = 0;
+    int32_t limit = 0;
+    int32_t width = 0;
+    int32_t top = 0;
+
+    ~paint_row_cache_t(void)
+    {
+      if (rows) heap_free(rows);
+      if (tags) heap_free(tags);
+    }
 
-  void LGFXBase::floodFill(int32_t x, int32_t y)
+    bool init(int32_t w, int32_t t, int32_t h)
+    {
+      width = w;
+      top = t;
+      limit = h;
+      return resize(std::min<int32_t>(h, 16));
+    }
+
+    bool grow(void)
+    {
+      return slots < limit && resize(std::min<int32_t>(slots << 1, limit));
+    }
+
+    bool resize(int32_t newslots)
+    {
+      auto newrows = (uint8_t*)heap_alloc(newslots * width);
+      if (newrows == nullptr) { return false; }
+      auto newtags = (int32_t*)heap_alloc(newslots * sizeof(int32_t));
+      if (newtags == nullptr) { heap_free(newrows); return false; }
+      for (int32_t i = 0; i < newslots; ++i) { newtags[i] = INT32_MIN; }
+      // 保持していた行を移す。移し先が重なった行は捨てて後で読み直す。
+      for (int32_t i = 0; i < slots; ++i)
+      {
+        if (tags[i] == INT32_MIN) { continue; }
+        int32_t slot = (tags[i] - top) % newslots;
+        if (newtags[slot] != INT32_MIN) { continue; }
+        newtags[slot] = tags[i];
+        memcpy(&newrows[slot * width], &rows[i * width], width);
+      }
+      if (rows) heap_free(rows);
+      if (tags) heap_free(tags);
+      rows = newrows;
+      tags = newtags;
+      slots = newslots;
+      return true;
+    }
+  };
+
+  bool LGFXBase::floodFill(int32_t x, int32_t y)
   {
-    if (x < _clip_l || x > _clip_r || y < _clip_t || y > _clip_b) return;
+    if (x < _clip_l || x > _clip_r || y < _clip_t || y > _clip_b) return true;
     bgr888_t target;
     readRectRGB(x, y, 1, 1, &target);
-    if (_color.raw == _write_conv.convert(lgfx::color888(target.r, target.g, target.b))) return;
+    if (_color.raw == _write_conv.convert(lgfx::color888(target.r, target.g, target.b))) return true;
 
     pixelcopy_t p;
     p.transp = _read_conv.convert(lgfx::color888(target.r, target.g, target.b));
@@ -1883,91 +2524,85 @@ namespace lgfx
     }
 
     const int32_t cl = _clip_l;
-    const int32_t w = _clip_r - cl + 1;
-    size_t bufIdx = 0;
-    uint8_t* linebufs[3] = { new uint8_t[w], new uint8_t[w], new uint8_t[w] };
-    int32_t bufY[3] = {y, -2, -2};  // 3 line buffer (default: out of range.)
-    _panel->readRect(cl, y, w, 1, linebufs[0], &p);
-    std::list<paint_point_t> points;
-    points.push_back({x, x, y, y});
-
-    startWrite();
-    while (!points.empty())
+    const int32_t cr = _clip_r;
+    const int32_t ct = _clip_t;
+    const int32_t cb = _clip_b;
+    const int32_t w = cr - cl + 1;
+
+    paint_row_cache_t cache;
+    if (!cache.init(w, ct, cb - ct + 1)) return false;
+    paint_span_stack_t stack;
+    fill_rect_batch_t batch(_panel, _color.raw, cl, ct, cr, cb);
+
+    // 指定行の判定結果を返す。非0の画素が未だ塗られていない対象色。
+    auto get_row = [&](int32_t ry) -> uint8_t*
     {
-      int32_t y0 = bufY[bufIdx];
-
-      auto it = points.begin();
-      int32_t counter = 0;
-      while (it->y != y0 && ++it != points.end()) ++counter;
-      if (it == points.end())
+      int32_t slot = (ry - ct) % cache.slots;
+      if (cache.tags[slot] != ry && cache.tags[slot] != INT32_MIN && cache.grow())
       {
-        if (counter < 256)
-        {
-          ++bufIdx;
-          int32_t y1 = bufY[(bufIdx  )%3];
-          int32_t y2 = bufY[(bufIdx+1)%3];
-          it = points.begin();
-
-          while ((it->y != y1) && (it->y != y2) && (++it != points.end()));
-        }
-        bufIdx = 0;
-        if (it == points.end())
-        {
-          it = points.begin();
-
-          bufY[0] = it->y;
-          p.src_x32_add = 1 << FP_SCALE;
-          p.src_y32_add = 0;
-          _panel->readRect(cl, it->y, w, 1, linebufs[0], &p);
-        }
-        else
-        {
-          for (; bufIdx < 2; ++bufIdx) if (it->y == bufY[bufIdx]) break;
-        }
+        slot = (ry - ct) % cache.slots;
       }
-      auto linebuf = &linebufs[bufIdx][- cl];
-
-      int32_t lx = it->lx;
-      int32_t rx = it->rx;
-      int32_t ly = it->y;
-      int32_t oy = it->oy;
-      points.erase(it);
-      if (!linebuf[lx]) continue;
-
-      int32_t lxsav = lx - 1;
-      int32_t rxsav = rx + 1;
-
-      const int32_t cr = _clip_r;
-      while (lx > cl && linebuf[lx - 1]) --lx;
-      while (rx < cr && linebuf[rx + 1]) ++rx;
-      bool flg_noexpanded = lx >= lxsav && rxsav >= rx;
+      auto row = &cache.rows[slot * w];
+      if (cache.tags[slot] != ry)
+      {
+        cache.tags[slot] = ry;
+        batch.flush(); // the row must be read after the pending fills
+        p.src_x32_add = 1 << FP_SCALE;
+        p.src_y32_add = 0;
+        _panel->readRect(cl, ry, w, 1, row, &p);
+      }
+      return row - cl;
+    };
+    // 区間を積めなかった場合は塗り残しが出るため、以降の処理を打ち切る。
+    bool complete = true;
+    auto push = [&](int32_t lx, int32_t rx, int32_t ny, int32_t dy)
+    {
+      if (ny >= ct && ny <= cb && !stack.push(lx, rx, ny, dy)) { complete = false; }
+    };
 
-      memset(&linebuf[lx], 0, rx - lx + 1);
-      writeFillRectPreclipped(lx, ly, rx - lx + 1, 1);
+    push(x, x, y, -1);
+    push(x, x, y + 1, 1);
 
-      int32_t nexty[2] = { ly - 1, ly + 1 };
-      if (ly < y) std::swap(nexty[0], nexty[1]);
-      size_t i = 0;
+    startWrite();
+    while (stack.count && complete)
+    {
+      auto sp = stack.spans[--stack.count];
+      int32_t x1 = sp.lx;
+      int32_t x2 = sp.rx;
+      int32_t ly = sp.y;
+      int32_t dy = sp.dy;
+      auto linebuf = get_row(ly);
+
+      int32_t lx = x1;
+      while (lx >= cl && linebuf[lx]) --lx;
+      int32_t xe = x1;
+      bool hit = lx < x1;
+      if (hit)
+      {
+        ++lx;
+        // 親の区間より左に広がった部分は逆方向にも漏れ出す
+        if (lx < x1) push(lx, x1 - 1, ly - dy, -dy);
+        xe = x1 + 1;
+      }
       do
       {
-        int32_t newy = nexty[i];
-        if (newy == oy && flg_noexpanded) continue;
-        if (newy < _clip_t || newy > _clip_b) continue;
-        size_t bidx = 0;
-        while (newy != bufY[bidx] && ++bidx != 3);
-        if (bidx == 3) {
-          for (bidx = 0; bidx < 2 && (abs(bufY[bidx] - ly) <= 1); ++bidx);
-          bufY[bidx] = newy;
-          p.src_x32_add = 1 << FP_SCALE;
-          p.src_y32_add = 0;
-          _panel->readRect(cl, newy, w, 1, linebufs[bidx], &p);
+        if (hit)
+        {
+          while (xe <= cr && linebuf[xe]) ++xe;
+          int32_t rx = xe - 1;
+          memset(&linebuf[lx], 0, xe - lx);
+          batch.add_preclipped(lx, ly, xe - lx, 1);
+          push(lx, rx, ly + dy, dy);
+          if (rx > x2) push(x2 + 1, rx, ly - dy, -dy);
         }
-        paint_add_points(points, lx ,rx, newy, ly, &linebufs[bidx][- cl]);
-      } while (++i < 2);
+        while (++xe <= x2 && !linebuf[xe]);
+        lx = xe;
+        hit = true;
+      } while (xe <= x2);
     }
-    size_t i = 0;
-    do { delete[] linebufs[i]; } while (++i != 3);
+    batch.flush();
     endWrite();
+    return complete;
   }
 
 //----------------------------------------------------------------------------
@@ -2223,6 +2858,11 @@ namespace lgfx
     {
       font->getDefaultMetric(&metrics);
     }
+    if (_text_run_cache)
+    {
+      size_t width;
+      if (_text_run_cache->drawString(this, string, x, y, datum, font, &width)) { return width; }
+    }
     int16_t sumX = 0;
     int32_t cwidth = text_width(string, font, &metrics); // Find the pixel width of the string in the font
     int32_t sy = 65536 * _text_style.size_y;
@@ -2434,7 +3074,12 @@ namespace lgfx
   {
     if (_font == font) return;
 
-    _runtime_font.reset();
+    if (_runtime_font.get() != nullptr)
+    {
+      _runtime_font.reset();
+      // a new font may be loaded at the same address.
+      if (_text_run_cache) { _text_run_cache->clear(); }
+    }
     if (font == nullptr) font = &fonts::Font0;
     _font = font;
     //_decoderState = utf8_decode_state_t::utf8_state0;
@@ -2501,7 +3146,9 @@ namespace lgfx
     else
 #endif
     {
-      this->_runtime_font.reset(new VLWfont());
+      auto vlw = new VLWfont();
+      vlw->setCacheConfig(_font_cache_cfg);
+      this->_runtime_font.reset(vlw);
     }
 
     if (this->_runtime_font->loadFont(data)) {
@@ -2519,6 +3166,15 @@ namespace lgfx
     if (_runtime_font.get() != nullptr) { setFont(&fonts::Font0); }
   }
 
+  void LGFXBase::setFontCacheConfig(const VLWfont::cache_config_t& cfg)
+  {
+    _font_cache_cfg = cfg;
+    if (_runtime_font.get() != nullptr && _runtime_font->getType() == IFont::ft_vlw)
+    {
+      static_cast<VLWfont*>(_runtime_font.get())->setCacheConfig(cfg);
+    }
+  }
+
   void LGFXBase::showFont(uint32_t td)
   {
     int_fast16_t x = 0;
@@ -2935,7 +3591,7 @@ namespace lgfx
     lgfxJdec jpegdec;
 
     static constexpr uint16_t sz_pool = 3900;
-    uint8_t *pool = (uint8_t*)heap_alloc_dma(sz_pool);
+    uint8_t *pool = (uint8_t*)buffer_alloc(sz_pool, AllocationSource::Dma);
     if (!pool)
     {
       // ESP_LOGW("LGFX", "jpeg memory alloc fail");
@@ -2947,10 +3603,30 @@ namespace lgfx
     if (jres != JDR_OK)
     {
       // ESP_LOGW("LGFX", "jpeg prepare error:%x", jres);
-      heap_free(pool);
+      buffer_free(pool);
       return false;
     }
 
+    _jpg_peak_memory = sz_pool;
+    void* coef_alloc = nullptr;
+    if (jpegdec.progressive)
+    {
+      _jpg_peak_memory += jpegdec.sz_coef;
+      void* coef = _jpg_coef_buf;
+      if (_jpg_coef_len < jpegdec.sz_coef)
+      {
+        coef = coef_alloc = buffer_alloc(jpegdec.sz_coef, AllocationSource::Psram);
+        if (!coef) { coef = coef_alloc = buffer_alloc(jpegdec.sz_coef, AllocationSource::Normal); }
+        if (!coef)
+        {
+          // ESP_LOGW("LGFX", "jpeg coefficient memory alloc fail");
+          buffer_free(pool);
+          return false;
+        }
+      }
+      jpegdec.coefbuf = (int16_t*)coef;
+    }
+
     if (!drawinfo.begin( this
                        , x
                        , y
@@ -2963,7 +3639,8 @@ namespace lgfx
                        , datum
                        , jpegdec.width, jpegdec.height))
     {
-      heap_free(pool);
+      buffer_free(coef_alloc);
+      buffer_free(pool);
       return false;
     }
 
@@ -2982,15 +3659,23 @@ namespace lgfx
       drawinfo.zoom_y *= 1 << div;
     }
 
+    bool affine = drawinfo.zoom_x != 1.0f || drawinfo.zoom_y != 1.0f;
+    if (!affine && getColorDepth() == rgb565_2Byte)
+    { // 16bit出力先ではデコーダが直接 swap565 を出力し、pixelcopy での変換を省く
+      jpegdec.format = JD_FMT_SWAP565;
+      pc = pixelcopy_t(nullptr, rgb565_2Byte, swap565_t::depth, false);
+    }
+
     this->startWrite(!data->hasParent());
 
-    jres = lgfx_jd_decomp(&jpegdec, drawinfo.zoom_x == 1.0f && drawinfo.zoom_y == 1.0f ? jpg_push_image : jpg_push_image_affine, div);
+    jres = lgfx_jd_decomp(&jpegdec, affine ? jpg_push_image_affine : jpg_push_image, div);
 
     drawinfo.end();
     this->endWrite();
     drawinfo.data->preRead();
 
-    heap_free(pool);
+    buffer_free(coef_alloc);
+    buffer_free(pool);
 
     if (jres != JDR_OK) {
       // ESP_LOGW("LGFX", "jpeg decomp error:%x", jres);
@@ -3003,6 +3688,14 @@ namespace lgfx
   {
     bgra8888_t* lineBuffer;
     pixelcopy_t *pc;
+
+    // 複数行をまとめて描画するための帯バッファ (maxWidth x strip_cap 画素)
+    bgra8888_t* strip = nullptr;
+    pixelcopy_t pc_blend;
+    int32_t strip_y = 0;      // 帯の先頭行 (maxHeight内の座標)
+    uint16_t strip_rows = 0;  // 蓄積中の行数
+    uint16_t strip_cap = 0;
+    bool strip_alpha = false; // 不透明でない画素を含む
   };
 
 //-----
@@ -3061,7 +3754,7 @@ namespace lgfx
       {
         if (p->lineBuffer == nullptr)
         {
-          p->lineBuffer = (bgra8888_t*)heap_alloc_dma(sizeof(bgra8888_t) * p->maxWidth);
+          p->lineBuffer = (bgra8888_t*)buffer_alloc(sizeof(bgra8888_t) * p->maxWidth, AllocationSource::Dma);
         }
         p->gfx->readRect(p->x, p->y + y0, p->maxWidth, 1, p->lineBuffer);
         do
@@ -3158,7 +3851,7 @@ namespace lgfx
 
     if (p->lineBuffer == nullptr)
     {
-      p->lineBuffer = (bgra8888_t*)heap_alloc_dma(sizeof(bgra8888_t) * p->maxWidth);
+      p->lineBuffer = (bgra8888_t*)buffer_alloc(sizeof(bgra8888_t) * p->maxWidth, AllocationSource::Dma);
       p->pc->src_data = p->lineBuffer;
     }
 
@@ -3295,13 +3988,137 @@ namespace lgfx
   }
 
 
-  static pngle_t* pngle = nullptr;
-  void LGFXBase::releasePngMemory(void)
+  static constexpr uint16_t PNG_STRIP_ROWS = 16;
+
+  // 帯バッファを確保する。確保できない場合は行数を減らし、それでも駄目なら行ごとの描画を使う
+  static bool png_strip_begin(png_file_decoder_t* p)
+  {
+    auto depth = p->gfx->getColorDepth();
+    auto fp_blend = (depth == rgb565_2Byte) ? pixelcopy_t::blend_rgb_fast<swap565_t, bgra8888_t>
+                  : (depth == rgb888_3Byte) ? pixelcopy_t::blend_rgb_fast<bgr888_t , bgra8888_t>
+                  : (depth == rgb666_3Byte) ? pixelcopy_t::blend_rgb_fast<bgr666_t , bgra8888_t>
+                  : (depth == rgb332_1Byte) ? pixelcopy_t::blend_rgb_fast<rgb332_t , bgra8888_t>
+                  : nullptr;
+    if (fp_blend == nullptr || p->gfx->hasPalette()) { return false; }
+
+    uint32_t rows = std::min<int32_t>(PNG_STRIP_ROWS, p->maxHeight);
+    for (; rows > 1; rows >>= 1)
+    {
+      p->strip = (bgra8888_t*)buffer_alloc(sizeof(bgra8888_t) * p->maxWidth * rows, AllocationSource::Dma);
+      if (p->strip) { break; }
+    }
+    if (p->strip == nullptr) { return false; }
+    p->strip_cap = rows;
+    p->strip_rows = 0;
+    p->pc_blend = pixelcopy_t(p->strip, depth, bgra8888_t::depth);
+    p->pc_blend.fp_copy = fp_blend;
+    return true;
+  }
+
+  static void png_strip_flush(png_file_decoder_t* p)
+  {
+    uint32_t rows = p->strip_rows;
+    if (rows == 0) { return; }
+    p->strip_rows = 0;
+    p->data->postRead();
+
+    auto gfx = p->gfx;
+    int32_t w = p->maxWidth;
+    int32_t y = p->y + p->strip_y;
+    if (!p->strip_alpha)
+    { // 不透明な帯は一回の転送で描画する
+      p->pc->src_data = p->strip;
+      p->pc->src_x32_add = 1 << FP_SCALE;
+      p->pc->src_y32_add = 0;
+      gfx->pushImage(p->x, y, w, rows, p->pc, true);
+    }
+    else if (gfx->isReadable())
+    { // 透過を含む帯は描画先と合成する
+      p->pc_blend.src_x32_add = 1 << FP_SCALE;
+      p->pc_blend.src_y32_add = 0;
+      gfx->pushAlphaImage(p->x, y, w, rows, &p->pc_blend);
+    }
+    else
+    { // 読出しできない描画先では、不透明度が閾値を超える画素の区間だけを描画する
+      p->pc->src_data = p->strip;
+      p->pc->src_bitwidth = w;
+      p->pc->src_x32_add = 1 << FP_SCALE;
+      p->pc->src_y32_add = 0;
+      for (uint32_t row = 0; row < rows; ++row)
+      {
+        auto line = &p->strip[row * w];
+        int32_t l = 0;
+        for (;;)
+        {
+          while (l < w && line[l].a <= LGFX_ALPHABLEND_NONREADABLE_THRESH) { ++l; }
+          if (l == w) { break; }
+          int32_t r = l;
+          while (++r < w && line[r].a > LGFX_ALPHABLEND_NONREADABLE_THRESH);
+          gfx->pushImageRegion(p->x + l, y + row, r - l, 1, l, row, p->pc, false);
+          l = r;
+        }
+      }
+    }
+  }
+
+  static void png_strip_end(png_file_decoder_t* p)
   {
-    if (pngle) {
-      lgfx_pngle_destroy(pngle);
-      pngle = nullptr;
+    if (p->strip == nullptr) { return; }
+    png_strip_flush(p);
+    p->gfx->waitDMA();
+    buffer_free(p->strip);
+    p->strip = nullptr;
+  }
+
+  // 等倍・非インターレースの画像で使用し、行を帯バッファに溜めてからまとめて描画する
+  static void png_draw_strip_callback(void *user_data, uint32_t x, uint32_t y, uint_fast8_t, size_t len, const uint8_t* argb)
+  {
+    auto p = (png_file_decoder_t*)user_data;
+
+    int32_t y0 = (int32_t)y - p->offY;
+    if (y0 < 0 || y0 >= p->maxHeight) return;
+
+    int32_t l = (int32_t)x - p->offX;
+    int32_t r = l + (int32_t)len;
+    if (l < 0) { argb -= l * 4; l = 0; }
+    if (r > p->maxWidth) { r = p->maxWidth; }
+    if (l >= r) return;
+
+    uint32_t rows = p->strip_rows;
+    if (rows == 0 || y0 != p->strip_y + (int32_t)rows - 1)
+    { // 新しい行
+      if (rows && (rows == p->strip_cap || y0 != p->strip_y + (int32_t)rows))
+      {
+        png_strip_flush(p);
+        rows = 0;
+      }
+      if (rows == 0)
+      {
+        p->gfx->waitDMA();
+        p->strip_y = y0;
+        p->strip_alpha = false;
+      }
+      p->strip_rows = ++rows;
     }
+
+    auto dst = &p->strip[(rows - 1) * p->maxWidth + l];
+    memcpy(dst, argb, (r - l) * sizeof(bgra8888_t));
+    if (!p->strip_alpha)
+    {
+      do
+      {
+        if (dst->a != 255) { p->strip_alpha = true; break; }
+        ++dst;
+      } while (++l < r);
+    }
+  }
+
+  // setPngDecoder で作業領域を渡されていないインスタンスが共有する作業領域
+  static LGFX_PngDecoder png_shared_decoder;
+
+  void LGFXBase::releasePngMemory(void)
+  {
+    png_shared_decoder.release();
   }
 
   bool LGFXBase::draw_png(DataWrapper* data, int32_t x, int32_t y, int32_t maxWidth, int32_t maxHeight, int32_t offX, int32_t offY, float zoom_x, float zoom_y, datum_t datum)
@@ -3309,9 +4126,9 @@ namespace lgfx
     /// PNG描画を繰り返し使用した場合、pngleのメモリ確保に失敗するケースがある。
     /// そのため、pngle使用後に解放せず、再利用できる構成に変更した。
     /// メモリを明示的に解放したい場合は releasePngMemory を使用する。
-    if (pngle == nullptr) {
-      pngle = lgfx_pngle_new();
-    }
+    /// 作業領域は全インスタンスで1つを共有する。別のスレッドで同時に描画する場合は setPngDecoder でそれぞれに渡すこと。
+    auto decoder = _png_decoder ? _png_decoder : &png_shared_decoder;
+    auto pngle = static_cast<pngle_t*>(decoder->getContext());
     if (pngle == nullptr) { return false; }
 
     prepareTmpTransaction(data);
@@ -3354,14 +4171,23 @@ namespace lgfx
 
     png.pc = &pc;
 
+    auto callback = png_draw_alpha_scale_callback;
+    if (png.zoom_x == 1.0f && png.zoom_y == 1.0f)
+    {
+      callback = (lgfx_pngle_get_ihdr(pngle)->interlace == 0 && png_strip_begin(&png))
+               ? png_draw_strip_callback
+               : png_draw_alpha_callback;
+    }
+
     this->startWrite(!data->hasParent());
 
-    auto res = lgfx_pngle_decomp(pngle, png.zoom_x == 1.0f && png.zoom_y == 1.0f ? png_draw_alpha_callback : png_draw_alpha_scale_callback);
+    auto res = lgfx_pngle_decomp(pngle, callback);
+    png_strip_end(&png);
 
     this->endWrite();
     if (png.lineBuffer) {
       this->waitDMA();
-      heap_free(png.lineBuffer);
+      buffer_free(png.lineBuffer);
     }
     png.end();
 
@@ -3411,19 +4237,26 @@ namespace lgfx
       pc.fp_skip = pixelcopy_t::skip_rgb_affine<bgra8888_t>;
       pc.fp_copy = pixelcopy_t::get_fp_copy_rgb_affine<bgra8888_t>(pc.dst_depth);
     }
-    png.lineBuffer = (bgra8888_t*)heap_alloc_dma(sizeof(bgra8888_t) * png.maxWidth);
+    png.lineBuffer = (bgra8888_t*)buffer_alloc(sizeof(bgra8888_t) * png.maxWidth, AllocationSource::Dma);
     pc.src_data = png.lineBuffer;
 
     png.pc = &pc;
 
+    auto callback = png_draw_alpha_scale_callback;
+    if (png.zoom_x == 1.0f && png.zoom_y == 1.0f)
+    {
+      callback = png_strip_begin(&png) ? png_draw_strip_callback : png_draw_alpha_callback;
+    }
+
     this->startWrite(!data->hasParent());
 
-    auto res = lgfx_qoi_decomp(qoi, png.zoom_x == 1.0f && png.zoom_y == 1.0f ? png_draw_alpha_callback : png_draw_alpha_scale_callback);
+    auto res = lgfx_qoi_decomp(qoi, callback);
+    png_strip_end(&png);
 
     this->endWrite();
     if (png.lineBuffer) {
       this->waitDMA();
-      heap_free(png.lineBuffer);
+      buffer_free(png.lineBuffer);
     }
     png.end();
     lgfx_qoi_destroy(qoi);
@@ -3457,13 +4290,13 @@ namespace lgfx
     if (h > height() - y) h = height() - y;
     if (h < 1) return nullptr;
 
-    void* rgbBuffer = heap_alloc_dma(w * 3);
+    void* rgbBuffer = buffer_alloc(w * 3, AllocationSource::Dma);
 
     png_encoder_t enc = { this, x, y };
 
     auto res = tdefl_write_image_to_png_file_in_memory_ex_with_cb(rgbBuffer, w, h, 3, datalen, 6, 0, (tdefl_get_png_row_func)png_encoder_get_row, &enc);
 
-    heap_free(rgbBuffer);
+    buffer_free(rgbBuffer);
 
     return res;
   }
@@ -27,6 +27,7 @@ Contributors:
 #include "platforms/common.hpp"
 #include "misc/enum.hpp"
 #include "misc/colortype.hpp"
+#include "misc/range.hpp"
 #include "misc/pixelcopy.hpp"
 #include "misc/DataWrapper.hpp"
 #include "lgfx_fonts.hpp"
@@ -52,6 +53,8 @@ namespace lgfx
 #define LGFX_PRINTF_ENABLED
 #endif
 
+  class LGFX_TextRunCache;
+  class LGFX_PngDecoder;
 
   class LGFXBase
 #if defined (ARDUINO)
@@ -235,6 +238,9 @@ namespace lgfx
                   void drawTriangle    ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
     LGFX_INLINE_T void fillTriangle    ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const T& color)  { setColor(color); fillTriangle(x0, y0, x1, y1, x2, y2); }
                   void fillTriangle    ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+    /// Fills a polygon. Pixels whose center is inside are drawn, so polygons sharing an edge do not overlap.
+    LGFX_INLINE_T void fillPolygon     ( const point_t* points, size_t count, const T& color, fill_rule_t rule = NONZERO) { setColor(color); fillPolygon(points, count, rule); }
+                  void fillPolygon     ( const point_t* points, size_t count, fill_rule_t rule = NONZERO);
     LGFX_INLINE_T void drawBezier      ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, const T& color)  { setColor(color); drawBezier(x0, y0, x1, y1, x2, y2); }
                   void drawBezier      ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
     LGFX_INLINE_T void drawBezier      ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, const T& color)  { setColor(color); drawBezier(x0, y0, x1, y1, x2, y2, x3, y3); }
@@ -251,10 +257,11 @@ namespace lgfx
                   void drawCircleHelper( int32_t x, int32_t y, int32_t r, uint_fast8_t cornername);
     LGFX_INLINE_T void fillCircleHelper( int32_t x, int32_t y, int32_t r, uint_fast8_t corners, int32_t delta, const T& color)  { setColor(color); fillCircleHelper(x, y, r, corners, delta); }
                   void fillCircleHelper( int32_t x, int32_t y, int32_t r, uint_fast8_t corners, int32_t delta);
-    LGFX_INLINE_T void floodFill( int32_t x, int32_t y, const T& color) { setColor(color); floodFill(x, y); }
-                  void floodFill( int32_t x, int32_t y                );
-    LGFX_INLINE_T void paint    ( int32_t x, int32_t y, const T& color) { setColor(color); floodFill(x, y); }
-    LGFX_INLINE   void paint    ( int32_t x, int32_t y                ) {                  floodFill(x, y); }
+    /// @return false if a work buffer could not be allocated and the fill stopped part-way.
+    LGFX_INLINE_T bool floodFill( int32_t x, int32_t y, const T& color) { setColor(color); return floodFill(x, y); }
+                  bool floodFill( int32_t x, int32_t y                );
+    LGFX_INLINE_T bool paint    ( int32_t x, int32_t y, const T& color) { setColor(color); return floodFill(x, y); }
+    LGFX_INLINE   bool paint    ( int32_t x, int32_t y                ) {                  return floodFill(x, y); }
 
     LGFX_INLINE_T void fillAffine(const float matrix[6], int32_t w, int32_t h, const T& color) { setColor(color); fillAffine(matrix, w, h); }
                   void fillAffine(const float matrix[6], int32_t w, int32_t h);
@@ -296,6 +303,10 @@ namespace lgfx
     LGFX_INLINE_T void fillSmoothCircle(int32_t x, int32_t y, int32_t r, const T& color) { setColor(color); fillSmoothCircle(x, y, r); }
                   void fillSmoothCircle(int32_t x, int32_t y, int32_t r) { fillSmoothRoundRect(x-r, y-r, r*2+1, r*2+1, r); }
 
+    /// Anti-aliased fillPolygon with sub-pixel vertices. (integer coordinates are pixel centers)
+    LGFX_INLINE_T void fillSmoothPolygon(const pointf_t* points, size_t count, const T& color, fill_rule_t rule = NONZERO) { setColor(color); fillSmoothPolygon(points, count, rule); }
+                  void fillSmoothPolygon(const pointf_t* points, size_t count, fill_rule_t rule = NONZERO);
+
     LGFX_INLINE_T void fillScreen  ( const T& color) { setColor(color); fillRect(0, 0, width(), height()); }
     LGFX_INLINE   void fillScreen  ( void )          {                  fillRect(0, 0, width(), height()); }
 
@@ -317,6 +328,9 @@ namespace lgfx
     LGFX_INLINE   bool isEPD(void) const { return _panel->isEpd(); }
     LGFX_INLINE   bool getSwapBytes(void) const { return _swapBytes; }
     LGFX_INLINE   void setSwapBytes(bool swap) { _swapBytes = swap; }
+    /// Ordered dithering of gradient fills on RGB565 targets. (default: false)
+    LGFX_INLINE   bool getGradientDither(void) const { return _gradient_dither; }
+    LGFX_INLINE   void setGradientDither(bool enable) { _gradient_dither = enable; }
     LGFX_INLINE   bool isBusShared(void) const { return _panel->isBusShared(); }
     [[deprecated("use isBusShared()")]]
     LGFX_INLINE   bool isSPIShared(void) const { return _panel->isBusShared(); }
@@ -440,6 +454,10 @@ namespace lgfx
 
     void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, pixelcopy_t *param, bool use_dma = false);
 
+    // 大きな画像の一部 (src_x, src_y から w x h) を転送する。param->src_bitwidth は呼出し側で元画像の幅を設定しておくこと
+    /// Pushes the w x h region at (src_x, src_y) of a larger image. param->src_bitwidth must hold the source stride in pixels.
+    void pushImageRegion(int32_t x, int32_t y, int32_t w, int32_t h, int32_t src_x, int32_t src_y, pixelcopy_t *param, bool use_dma = false);
+
 //----------------------------------------------------------------------------
 
     template<typename T>
@@ -823,6 +841,16 @@ namespace lgfx
     /// unload VLW font
     void unloadFont(void);
 
+    /// Reuse rendered drawString runs. (nullptr = disabled)
+    /// The cache is not owned, and may be shared between several instances.
+    void setTextRunCache(LGFX_TextRunCache* cache) { _text_run_cache = cache; }
+    LGFX_TextRunCache* getTextRunCache(void) const { return _text_run_cache; }
+
+    /// VLW font glyph cache / preload settings.
+    /// cache_bytes is applied to the loaded font at once, the preload range on the next loadFont.
+    void setFontCacheConfig(const VLWfont::cache_config_t& cfg);
+    const VLWfont::cache_config_t& getFontCacheConfig(void) const { return _font_cache_cfg; }
+
     /// show VLW font
     void showFont(uint32_t td = 2000);
 
@@ -975,8 +1003,24 @@ namespace lgfx
 
     void* createPng( size_t* datalen, int32_t x = 0, int32_t y = 0, int32_t width = 0, int32_t height = 0);
 
+    // PNGデコーダの作業領域は全インスタンスで1つを共有し、drawPngの度に再利用する
+    /// Frees the PNG decoder context (about 44 KB) shared by the instances without their own decoder. The next drawPng allocates it again.
+    /// A decoder given by setPngDecoder is not affected.
     void releasePngMemory(void);
 
+    /// Uses a caller-owned decoder context for drawPng instead of the shared one. (nullptr: use the shared one)
+    /// Give each thread that calls drawPng at the same time its own decoder.
+    void setPngDecoder(LGFX_PngDecoder* decoder) { _png_decoder = decoder; }
+    LGFX_PngDecoder* getPngDecoder(void) const { return _png_decoder; }
+
+    // プログレッシブJPEGは画像全体のDCT係数を保持する必要がある (画素あたり約2Byte~4Byte)。
+    // バッファを渡しておくとdrawJpgの度に確保せずに済む。足りない場合は内部で確保する
+    /// Buffer for the DCT coefficients of progressive JPEG (used when it is large enough, otherwise one is allocated per draw).
+    void setJpgCoefBuffer(void* buffer, size_t length) { _jpg_coef_buf = buffer; _jpg_coef_len = buffer ? length : 0; }
+
+    /// Work memory the last drawJpg needed (decoder pool + progressive coefficient buffer) in bytes.
+    size_t getJpgPeakMemory(void) const { return _jpg_peak_memory; }
+
     template<typename T>
     [[deprecated("use pushImage")]] void pushRect( int32_t x, int32_t y, int32_t w, int32_t h, const T* data) { pushImage(x, y, w, h, data); }
 
@@ -1013,10 +1057,17 @@ namespace lgfx
 
     uint16_t _palette_count = 0;
 
+    void* _jpg_coef_buf = nullptr;
+    uint32_t _jpg_coef_len = 0;
+    uint32_t _jpg_peak_memory = 0;
+
+    LGFX_PngDecoder* _png_decoder = nullptr;
+
     float _xpivot = 0.0f;   // x pivot point coordinate
     float _ypivot = 0.0f;   // x pivot point coordinate
 
     bool _swapBytes = false;
+    bool _gradient_dither = false;
 
     enum utf8_decode_state_t : uint8_t
     { utf8_state0 = 0
@@ -1036,6 +1087,8 @@ namespace lgfx
 
     std::shared_ptr<RunTimeFont> _runtime_font;  // run-time generated font
     std::shared_ptr<DataWrapper> _font_file;  // run-time font file
+    VLWfont::cache_config_t _font_cache_cfg;
+    LGFX_TextRunCache* _text_run_cache = nullptr;
     PointerWrapper _font_data;
 
     std::shared_ptr<DataWrapperFactory> _data_wrapper_factory;
@@ -1317,6 +1370,9 @@ namespace lgfx
 
     pixelcopy_t create_pc_gray(const uint8_t *image, lgfx::color_depth_t depth, uint32_t fore_rgb888, uint32_t back_rgb888);
 
+    // argb8888_t の画素を現在の色深度の画素へ合成する pixelcopy を作成する
+    pixelcopy_t create_pc_blend(void);
+
 //----------------------------------------------------------------------------
 
     static void make_rotation_matrix(float* result, float dst_x, float dst_y, float src_x, float src_y, float angle, float zoom_x, float zoom_y);
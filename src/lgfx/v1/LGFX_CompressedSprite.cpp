@@ -0,0 +1,296 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+
+#include "LGFX_CompressedSprite.hpp"
+
+#include "LGFX_Sprite.hpp"
+#include "misc/common_function.hpp"
+
+#include "../internal/algorithm.h"
+
+#include <string.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+// RLEの形式 : 先頭1Byteで種別と画素数を表す
+//   0x00-0x7F : 続く (n + 1) 画素をそのまま格納 (1～128画素)
+//   0x80-0xFF : 続く1画素を ((n & 0x7F) + 2) 回繰り返す (2～129画素)
+
+  // 24bit画素は4Byte単位で読まれるため、展開用バッファの末尾に余白を付ける
+  static constexpr uint32_t DECODE_PADDING = 4;
+
+  static constexpr uint32_t RLE_MAX_LITERAL = 128;
+  static constexpr uint32_t RLE_MAX_RUN = 129;
+
+  // 1行を符号化する。dstがnullptrの場合は長さだけを返す
+  static uint32_t rle_encode_row(uint8_t* dst, const uint8_t* src, uint32_t w, uint32_t bytes)
+  {
+    uint32_t len = 0;
+    uint32_t i = 0;
+    auto same = [src, bytes](uint32_t a, uint32_t b) { return 0 == memcmp(&src[a * bytes], &src[b * bytes], bytes); };
+    while (i < w)
+    {
+      uint32_t run = 1;
+      while (i + run < w && run < RLE_MAX_RUN && same(i, i + run)) { ++run; }
+      if (run >= 2)
+      {
+        if (dst)
+        {
+          dst[len] = 0x80 | (run - 2);
+          memcpy(&dst[len + 1], &src[i * bytes], bytes);
+        }
+        len += 1 + bytes;
+        i += run;
+        continue;
+      }
+      // 3画素以上の繰返しが始まるまでを非圧縮で格納する
+      uint32_t lit = 1;
+      while (i + lit < w && lit < RLE_MAX_LITERAL)
+      {
+        uint32_t p = i + lit;
+        if (p + 2 < w && same(p, p + 1) && same(p, p + 2)) { break; }
+        ++lit;
+      }
+      if (dst)
+      {
+        dst[len] = lit - 1;
+        memcpy(&dst[len + 1], &src[i * bytes], lit * bytes);
+      }
+      len += 1 + lit * bytes;
+      i += lit;
+    }
+    return len;
+  }
+
+  bool LGFX_CompressedSprite::createFromSprite(LGFX_Sprite* src)
+  {
+    if (src == nullptr || src->getBuffer() == nullptr) { return false; }
+    if (!createFromImage(src->getBuffer(), src->buffer_width(), src->buffer_height(), src->getColorDepth(), src->getPalette())) { return false; }
+    setPivot(src->getPivotX(), src->getPivotY());
+    return true;
+  }
+
+  bool LGFX_CompressedSprite::createFromImage(const void* data, int32_t w, int32_t h, color_depth_t depth, const bgr888_t* palette)
+  {
+    deleteSprite();
+    uint_fast8_t bits = depth & color_depth_t::bit_mask;
+    if (data == nullptr || w < 1 || h < 1 || (bits != 8 && bits != 16 && bits != 24)) { return false; }
+    bool has_palette = depth & color_depth_t::has_palette;
+    if (has_palette && palette == nullptr) { return false; }
+
+    uint32_t bytes = bits >> 3;
+    auto src = static_cast<const uint8_t*>(data);
+    uint32_t line = w * bytes;
+
+    // 1回目で全体の長さを求め、2回目で符号化する
+    uint32_t index_len = (h + 1) * sizeof(uint32_t);
+    uint32_t length = index_len;
+    for (int32_t y = 0; y < h; ++y)
+    {
+      length += rle_encode_row(nullptr, &src[y * line], w, bytes);
+    }
+    _data.reset(length, _psram ? AllocationSource::Psram : AllocationSource::Normal);
+    if (!_data) { return false; }
+
+    auto index = reinterpret_cast<uint32_t*>(_data.get());
+    uint32_t pos = index_len;
+    for (int32_t y = 0; y < h; ++y)
+    {
+      index[y] = pos;
+      pos += rle_encode_row(&_data[pos], &src[y * line], w, bytes);
+    }
+    index[h] = pos;
+
+    if (has_palette)
+    {
+      _palette.reset(256 * sizeof(bgr888_t), AllocationSource::Normal);
+      if (!_palette)
+      {
+        deleteSprite();
+        return false;
+      }
+      memcpy(_palette.get(), palette, 256 * sizeof(bgr888_t));
+    }
+
+    _length = length;
+    _width = w;
+    _height = h;
+    _depth = depth;
+    _bytes = bytes;
+    _xpivot = w >> 1;
+    _ypivot = h >> 1;
+    return true;
+  }
+
+  void LGFX_CompressedSprite::deleteSprite(void)
+  {
+    _data.release();
+    _palette.release();
+    _length = 0;
+    _width = 0;
+    _height = 0;
+  }
+
+  void LGFX_CompressedSprite::decodeRow(int32_t y, int32_t x, int32_t count, void* dst) const
+  {
+    uint32_t bytes = _bytes;
+    auto index = reinterpret_cast<const uint32_t*>(_data.get());
+    auto s = &_data[index[y]];
+    auto d = static_cast<uint8_t*>(dst);
+    int32_t pos = 0;
+    while (count > 0)
+    {
+      uint_fast8_t c = *s++;
+      int32_t n = (c & 0x80) ? (c & 0x7F) + 2 : c + 1;
+      if (pos + n <= x)
+      { // 読み飛ばす
+        pos += n;
+        s += (c & 0x80) ? bytes : n * bytes;
+        continue;
+      }
+      int32_t skip = (x > pos) ? x - pos : 0;
+      int32_t len = std::min(n - skip, count);
+      if (c & 0x80)
+      {
+        uint32_t color = 0;
+        memcpy(&color, s, bytes);
+        memset_multi(d, color, bytes, len);
+        s += bytes;
+      }
+      else
+      {
+        memcpy(d, &s[skip * bytes], len * bytes);
+        s += n * bytes;
+      }
+      d += len * bytes;
+      count -= len;
+      pos += n;
+      x = pos;
+    }
+  }
+
+  void LGFX_CompressedSprite::push_sprite(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp)
+  {
+    if (dst == nullptr || !_data) { return; }
+
+    // 転送先のクリップ範囲にかかる部分だけを展開する
+    int32_t cx, cy, cw, ch;
+    dst->getClipRect(&cx, &cy, &cw, &ch);
+    int32_t sx = std::max(0, cx - x);
+    int32_t sy = std::max(0, cy - y);
+    int32_t ex = std::min(_width , cx + cw - x);
+    int32_t ey = std::min(_height, cy + ch - y);
+    if (sx >= ex || sy >= ey) { return; }
+    int32_t w = ex - sx;
+
+    uint32_t line = w * _bytes;
+    int32_t rows = std::max<int32_t>(1, BLOCK_BYTES / line);
+    rows = std::min(rows, ey - sy);
+    auto buf = static_cast<uint8_t*>(heap_alloc(line * rows + DECODE_PADDING));
+    if (buf == nullptr) { return; }
+
+    pixelcopy_t p(buf, dst->getColorDepth(), _depth, dst->hasPalette(), _palette.img24(), transp);
+    dst->startWrite();
+    do
+    {
+      int32_t n = std::min(rows, ey - sy);
+      for (int32_t i = 0; i < n; ++i)
+      {
+        decodeRow(sy + i, sx, w, &buf[i * line]);
+      }
+      p.src_x32 = 0;
+      p.src_y32 = 0;
+      p.src_x32_add = 1 << pixelcopy_t::FP_SCALE;
+      p.src_y32_add = 0;
+      dst->pushImage(x + sx, y + sy, w, n, &p, false);
+      sy += n;
+    } while (sy < ey);
+    dst->endWrite();
+    heap_free(buf);
+  }
+
+  void LGFX_CompressedSprite::push_rotate_zoom(LovyanGFX* dst, float x, float y, float angle, float zoom_x, float zoom_y, uint32_t transp)
+  {
+    if (dst == nullptr || !_data) { return; }
+
+    // 横長の帯ごとに展開して回転描画する。帯の境界で隙間が出ないよう上下に1行ずつ重ねる
+    uint32_t line = _width * _bytes;
+    int32_t rows = std::max<int32_t>(1, BLOCK_BYTES / line);
+    rows = std::min(rows, _height);
+    auto buf = static_cast<uint8_t*>(heap_alloc(line * (rows + 2) + DECODE_PADDING));
+    if (buf == nullptr) { return; }
+
+    dst->startWrite();
+    for (int32_t y0 = 0; y0 < _height; y0 += rows)
+    {
+      int32_t top = std::max(0, y0 - 1);
+      int32_t bottom = std::min(_height, y0 + rows + 1);
+      for (int32_t i = top; i < bottom; ++i)
+      {
+        decodeRow(i, 0, _width, &buf[(i - top) * line]);
+      }
+      dst->pushImageRotateZoom(x, y, _xpivot, _ypivot - top, angle, zoom_x, zoom_y, _width, bottom - top, buf, transp, _depth, _palette.img24());
+    }
+    dst->endWrite();
+    heap_free(buf);
+  }
+
+  void LGFX_CompressedSprite::read_rect(int32_t x, int32_t y, int32_t w, int32_t h, void* data, pixelcopy_t* param)
+  {
+    if (!_data) { return; }
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (w > _width  - x) { w = _width  - x; }
+    if (h > _height - y) { h = _height - y; }
+    if (w < 1 || h < 1) { return; }
+
+    auto d = static_cast<uint8_t*>(data);
+    if (param == nullptr)
+    {
+      uint32_t line = w * _bytes;
+      do
+      {
+        decodeRow(y++, x, w, d);
+        d += line;
+      } while (--h);
+      return;
+    }
+
+    auto buf = static_cast<uint8_t*>(heap_alloc(w * _bytes + DECODE_PADDING));
+    if (buf == nullptr) { return; }
+    uint32_t dst_line = (w * param->dst_bits + 7) >> 3;
+    param->src_data = buf;
+    param->src_bitwidth = w;
+    do
+    {
+      decodeRow(y++, x, w, buf);
+      param->src_x32 = 0;
+      param->src_y32 = 0;
+      param->fp_copy(d, 0, w, param);
+      d += dst_line;
+    } while (--h);
+    heap_free(buf);
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
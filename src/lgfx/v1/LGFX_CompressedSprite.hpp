@@ -0,0 +1,144 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "LGFXBase.hpp"
+#include "misc/SpriteBuffer.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  class LGFX_Sprite;
+
+// 行ごとにRLE圧縮した読出し専用のスプライト。背景やアイコン集など描き換えない画像の省メモリ用。
+// 描画時は必要な行だけを展開して通常のpushImageで送る。
+/// Read-only sprite stored as row-indexed RLE, for static backgrounds and icon sets.
+/// Only the rows that are needed get decoded, in small blocks, when pushing or reading.
+/// Usage: bg.createFromSprite(&sprite); sprite.deleteSprite(); ... bg.pushSprite(&lcd, 0, 0);
+
+  class LGFX_CompressedSprite
+  {
+  public:
+    LGFX_CompressedSprite(LovyanGFX* parent = nullptr) : _parent(parent) {}
+    ~LGFX_CompressedSprite(void) { deleteSprite(); }
+
+    LGFX_CompressedSprite(const LGFX_CompressedSprite&) = delete;
+    LGFX_CompressedSprite& operator=(const LGFX_CompressedSprite&) = delete;
+
+    /// Use PSRAM for the compressed data when available. (default: false)
+    void setPsram(bool enabled) { _psram = enabled; }
+
+    /// Compress the pixels of a sprite. 8/16/24 bpp (including 8bit palette) are supported.
+    bool createFromSprite(LGFX_Sprite* src);
+
+    /// Compress a raw image. data is w*h pixels of the given depth, palette is needed for palette_8bit.
+    bool createFromImage(const void* data, int32_t w, int32_t h, color_depth_t depth, const bgr888_t* palette = nullptr);
+
+    void deleteSprite(void);
+
+    int32_t width(void) const { return _width; }
+    int32_t height(void) const { return _height; }
+    color_depth_t getColorDepth(void) const { return _depth; }
+    bool hasPalette(void) const { return _palette; }
+    /// Bytes used by the row index and the compressed rows.
+    uint32_t bufferLength(void) const { return _length; }
+    /// Bytes the same image takes as an uncompressed sprite.
+    uint32_t rawLength(void) const { return _width * _height * _bytes; }
+
+    void setPivot(float x, float y) { _xpivot = x; _ypivot = y; }
+    float getPivotX(void) const { return _xpivot; }
+    float getPivotY(void) const { return _ypivot; }
+
+    template<typename T>
+    void pushSprite(                int32_t x, int32_t y, const T& transp) { push_sprite(_parent, x, y, convert_transp(transp)); }
+    template<typename T>
+    void pushSprite(LovyanGFX* dst, int32_t x, int32_t y, const T& transp) { push_sprite(    dst, x, y, convert_transp(transp)); }
+    void pushSprite(                int32_t x, int32_t y) { push_sprite(_parent, x, y); }
+    void pushSprite(LovyanGFX* dst, int32_t x, int32_t y) { push_sprite(    dst, x, y); }
+
+    template<typename T> void pushRotateZoom(LovyanGFX* dst, float dst_x, float dst_y, float angle, float zoom_x, float zoom_y, const T& transp) { push_rotate_zoom(dst, dst_x, dst_y, angle, zoom_x, zoom_y, convert_transp(transp)); }
+                         void pushRotateZoom(LovyanGFX* dst, float dst_x, float dst_y, float angle, float zoom_x, float zoom_y)                  { push_rotate_zoom(dst, dst_x, dst_y, angle, zoom_x, zoom_y); }
+    template<typename T> void pushRotateZoom(                float dst_x, float dst_y, float angle, float zoom_x, float zoom_y, const T& transp) { push_rotate_zoom(_parent, dst_x, dst_y, angle, zoom_x, zoom_y, convert_transp(transp)); }
+                         void pushRotateZoom(                float dst_x, float dst_y, float angle, float zoom_x, float zoom_y)                  { push_rotate_zoom(_parent, dst_x, dst_y, angle, zoom_x, zoom_y); }
+
+    /// Read pixels converted to the type of data.
+    template<typename T>
+    void readRect(int32_t x, int32_t y, int32_t w, int32_t h, T* data)
+    {
+      auto palette = _palette.img24();
+      pixelcopy_t p(nullptr, get_depth<T>::value, _depth, false, palette);
+      if (std::is_same<rgb565_t, T>::value || std::is_same<rgb888_t, T>::value || std::is_same<argb8888_t, T>::value || std::is_same<grayscale_t, T>::value || p.fp_copy == nullptr)
+      {
+        p.no_convert = false;
+        if (palette)
+        {
+          p.fp_copy = pixelcopy_t::copy_palette_affine<T, bgr888_t>;
+        }
+        else
+        {
+          p.fp_copy = pixelcopy_t::get_fp_copy_rgb_affine_dst<T>(_depth);
+        }
+      }
+      read_rect(x, y, w, h, data, &p);
+    }
+
+    /// Read pixels in the stored format.
+    void readRectRaw(int32_t x, int32_t y, int32_t w, int32_t h, void* data) { read_rect(x, y, w, h, data, nullptr); }
+
+    /// Decode count pixels of row y starting at x, in the stored format.
+    void decodeRow(int32_t y, int32_t x, int32_t count, void* dst) const;
+
+  protected:
+    static constexpr uint32_t BLOCK_BYTES = 4096;  // 一度に展開する画素データの上限;
+
+    LovyanGFX* _parent;
+    SpriteBuffer _data;     // uint32_t row_index[height + 1] に続いて各行のRLEデータ;
+    SpriteBuffer _palette;
+    uint32_t _length = 0;
+    int32_t _width = 0;
+    int32_t _height = 0;
+    float _xpivot = 0;
+    float _ypivot = 0;
+    color_depth_t _depth = rgb565_2Byte;
+    uint8_t _bytes = 2;
+    bool _psram = false;
+
+    template<typename T>
+    uint32_t convert_transp(const T& transp) const
+    {
+      color_conv_t conv;
+      conv.setColorDepth(_depth);
+      return conv.convert(transp) & conv.colormask;
+    }
+
+    void push_sprite(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp = pixelcopy_t::NON_TRANSP);
+    void push_rotate_zoom(LovyanGFX* dst, float x, float y, float angle, float zoom_x, float zoom_y, uint32_t transp = pixelcopy_t::NON_TRANSP);
+    void read_rect(int32_t x, int32_t y, int32_t w, int32_t h, void* data, pixelcopy_t* param);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_CompressedSprite = lgfx::LGFX_CompressedSprite;
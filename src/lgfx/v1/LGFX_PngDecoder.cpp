@@ -0,0 +1,49 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+
+#include "LGFX_PngDecoder.hpp"
+
+#include "../utility/lgfx_pngle.h"
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  void LGFX_PngDecoder::release(void)
+  {
+    if (_context)
+    {
+      lgfx_pngle_destroy(static_cast<pngle_t*>(_context));
+      _context = nullptr;
+    }
+  }
+
+  void* LGFX_PngDecoder::getContext(void)
+  {
+    if (_context == nullptr)
+    {
+      _context = lgfx_pngle_new();
+    }
+    return _context;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,63 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+// PNGデコーダの作業領域 (inflateの状態と辞書で約44KB) を保持するオブジェクト。
+// 初回の描画で確保し、release() かデストラクタで解放するまで再利用する。
+// 同じオブジェクトを使う描画は同時に実行しないこと。
+/// Owns a PNG decoder context (inflate state and window, about 44 KB).
+/// It is allocated by the first drawPng that uses it and kept for reuse until release() or destruction.
+/// Usage: lcd.setPngDecoder(&decoder);
+/// Several LGFX instances drawing on the same thread may share one decoder.
+/// Decodes running at the same time need one decoder each.
+
+  class LGFX_PngDecoder
+  {
+  public:
+    LGFX_PngDecoder(void) = default;
+    ~LGFX_PngDecoder(void) { release(); }
+
+    LGFX_PngDecoder(const LGFX_PngDecoder&) = delete;
+    LGFX_PngDecoder& operator=(const LGFX_PngDecoder&) = delete;
+
+    /// Frees the context. The next drawPng allocates it again.
+    void release(void);
+
+    bool isAllocated(void) const { return _context != nullptr; }
+
+    /// Returns the context, allocating it if needed (nullptr when out of memory).
+    void* getContext(void);
+
+  protected:
+    void* _context = nullptr;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_PngDecoder = lgfx::LGFX_PngDecoder;
@@ -19,6 +19,13 @@ Contributors:
 #include "LGFX_Sprite.hpp"
 
 #include "misc/common_function.hpp"
+#include "misc/Allocator.hpp"
+#include "../utility/lgfx_tjpgd.h"
+
+#if defined ( __linux__ ) || defined ( __APPLE__ ) || defined ( _WIN32 )
+#include <thread>
+#include <vector>
+#endif
 
 #ifdef min
 #undef min
@@ -46,6 +53,7 @@ namespace lgfx
     _ye = h - 1;
 
     setRotation(_rotation);
+    _reset_dirty();
   }
 
   void Panel_Sprite::deleteSprite(void)
@@ -53,6 +61,7 @@ namespace lgfx
     _bitwidth = _panel_width = _panel_height = _width = _height = 0;
     setRotation(_rotation);
     _img.release();
+    _reset_dirty();
   }
 
   void* Panel_Sprite::createSprite(int32_t w, int32_t h, color_conv_t* conv, bool psram)
@@ -81,6 +90,7 @@ namespace lgfx
     memset(_img, 0, (_bitwidth * _write_bits >> 3) * _panel_height);
 
     setRotation(_rotation);
+    _reset_dirty();
 
     return _img;
   }
@@ -126,6 +136,7 @@ namespace lgfx
 
   void Panel_Sprite::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
   {
+    if (_dirty) { _mark_dirty(x, y, 1, 1); }
     uint_fast8_t r = _rotation;
     if (r)
     {
@@ -161,6 +172,7 @@ namespace lgfx
 
   void Panel_Sprite::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
   {
+    if (_dirty) { _mark_dirty(x, y, w, h); }
     uint_fast8_t r = _rotation;
     if (r)
     {
@@ -269,6 +281,27 @@ namespace lgfx
     }
   }
 
+  void Panel_Sprite::writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t raw_color)
+  {
+    uint_fast8_t bits = _write_bits;
+    bool fast = !_rotation && bits >= 8 && _img.use_memcpy();
+    uint_fast8_t bytes = bits >> 3;
+    uint_fast16_t bw = _bitwidth;
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto& r = rects[i];
+      if (fast && r.h == 1)
+      { // spans, the most common case
+        if (_dirty) { _mark_dirty(r.x, r.y, r.w, 1); }
+        memset_multi(&_img[(r.x + r.y * bw) * bytes], raw_color, bytes, r.w);
+      }
+      else
+      {
+        Panel_Sprite::writeFillRectPreclipped(r.x, r.y, r.w, r.h, raw_color);
+      }
+    }
+  }
+
   void Panel_Sprite::writeBlock(uint32_t rawcolor, uint32_t length)
   {
     do
@@ -325,6 +358,13 @@ namespace lgfx
   void Panel_Sprite::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
   {
     (void)use_dma;
+    if (_dirty)
+    { // ウィンドウ内で今回書込む行の範囲を記録する
+      uint32_t ww = _xe - _xs + 1;
+      uint32_t rows = (_xpos - _xs + length + ww - 1) / ww;
+      if (_ypos + rows > _ye + 1u) { _mark_dirty(_xs, _ys, ww, _ye - _ys + 1); }
+      else                         { _mark_dirty(_xs, _ypos, ww, rows); }
+    }
     uint_fast16_t xs = _xs;
     uint_fast16_t xe = _xe;
     uint_fast16_t ys = _ys;
@@ -428,6 +468,7 @@ namespace lgfx
 
   void Panel_Sprite::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool)
   {
+    if (_dirty) { _mark_dirty(x, y, w, h); }
     uint_fast8_t r = _rotation;
     if (r == 0 && param->transp == pixelcopy_t::NON_TRANSP && param->no_convert && _img.use_memcpy())
     {
@@ -488,6 +529,7 @@ namespace lgfx
 
   void Panel_Sprite::writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param)
   {
+    if (_dirty) { _mark_dirty(x, y, w, h); }
     uint32_t nextx = 0;
     uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
     if (_rotation)
@@ -607,6 +649,7 @@ namespace lgfx
 
   void Panel_Sprite::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
   {
+    if (_dirty) { _mark_dirty(dst_x, dst_y, w, h); }
     uint_fast8_t r = _rotation;
     if (r)
     {
@@ -680,6 +723,262 @@ namespace lgfx
     }
   }
 
+//----------------------------------------------------------------------------
+
+  void Panel_Sprite::setDirtyTracking(bool enable)
+  {
+    _dirty_tracking = enable;
+    _reset_dirty();
+  }
+
+  void Panel_Sprite::_reset_dirty(void)
+  {
+    _dirty.release();
+    _dirty_stride = 0;
+    if (!_dirty_tracking || !_panel_width || !_panel_height) { return; }
+
+    uint_fast16_t tiles_x = (_panel_width  + (1u << DIRTY_TILE_SHIFT) - 1) >> DIRTY_TILE_SHIFT;
+    uint_fast16_t tiles_y = (_panel_height + (1u << DIRTY_TILE_SHIFT) - 1) >> DIRTY_TILE_SHIFT;
+    uint_fast16_t stride = (tiles_x + 31) >> 5;
+    _dirty.reset(stride * tiles_y * sizeof(uint32_t), AllocationSource::Normal);
+    if (!_dirty) { return; }
+    _dirty_stride = stride;
+    // 内容が新しくなったので全体を変更済みとする
+    auto row = _dirty.img32();
+    for (uint_fast16_t ty = 0; ty < tiles_y; ++ty, row += stride)
+    {
+      for (uint_fast16_t i = 0; i < stride; ++i)
+      {
+        uint_fast16_t remain = tiles_x - (i << 5);
+        row[i] = (remain >= 32) ? ~0u : ((1u << remain) - 1);
+      }
+    }
+  }
+
+  void Panel_Sprite::clearDirty(void)
+  {
+    if (!_dirty) { return; }
+    uint_fast16_t tiles_y = (_panel_height + (1u << DIRTY_TILE_SHIFT) - 1) >> DIRTY_TILE_SHIFT;
+    memset(_dirty, 0, _dirty_stride * tiles_y * sizeof(uint32_t));
+  }
+
+  void Panel_Sprite::_mark_dirty(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    if (!w || !h) { return; }
+    uint_fast8_t r = _rotation;
+    if (r)
+    {
+      if ((1u << r) & 0b10010110) { y = _height - (y + h); }
+      if (r & 2)                  { x = _width  - (x + w); }
+      if (r & 1) { std::swap(x, y);  std::swap(w, h); }
+    }
+    uint_fast16_t tx0 = x >> DIRTY_TILE_SHIFT;
+    uint_fast16_t tx1 = (x + w - 1) >> DIRTY_TILE_SHIFT;
+    uint_fast16_t ty  = y >> DIRTY_TILE_SHIFT;
+    uint_fast16_t ty1 = (y + h - 1) >> DIRTY_TILE_SHIFT;
+    uint_fast16_t stride = _dirty_stride;
+    auto row = &_dirty.img32()[ty * stride];
+    do
+    {
+      for (uint_fast16_t tx = tx0; tx <= tx1; ++tx)
+      {
+        row[tx >> 5] |= 1u << (tx & 31);
+      }
+      row += stride;
+    } while (++ty <= ty1);
+  }
+
+  bool Panel_Sprite::popDirtyRect(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h)
+  {
+    if (!_dirty) { return false; }
+    auto bits = _dirty.img32();
+    uint_fast16_t stride = _dirty_stride;
+    uint_fast16_t tiles_x = (_panel_width  + (1u << DIRTY_TILE_SHIFT) - 1) >> DIRTY_TILE_SHIFT;
+    uint_fast16_t tiles_y = (_panel_height + (1u << DIRTY_TILE_SHIFT) - 1) >> DIRTY_TILE_SHIFT;
+    auto test = [bits](uint_fast16_t idx, uint_fast16_t tx) { return bits[idx + (tx >> 5)] & (1u << (tx & 31)); };
+
+    for (uint_fast16_t ty = 0; ty < tiles_y; ++ty)
+    {
+      uint_fast16_t idx = ty * stride;
+      uint_fast16_t tx0 = 0;
+      while (tx0 < tiles_x && !test(idx, tx0))
+      {
+        if (0 == (tx0 & 31) && !bits[idx + (tx0 >> 5)]) { tx0 += 32; }
+        else { ++tx0; }
+      }
+      if (tx0 >= tiles_x) { continue; }
+
+      // 横方向に連続するタイルを取り出し、下の行も同じ範囲が全て変更されていれば縦に延ばす
+      uint_fast16_t tx1 = tx0;
+      while (tx1 + 1 < tiles_x && test(idx, tx1 + 1)) { ++tx1; }
+      uint_fast16_t ty1 = ty;
+      for (;;)
+      {
+        uint_fast16_t tx = tx0;
+        do { bits[idx + (tx >> 5)] &= ~(1u << (tx & 31)); } while (++tx <= tx1);
+        if (ty1 + 1 >= tiles_y) { break; }
+        idx += stride;
+        for (tx = tx0; tx <= tx1 && test(idx, tx); ++tx) {}
+        if (tx <= tx1) { break; }
+        ++ty1;
+      }
+
+      x = tx0 << DIRTY_TILE_SHIFT;
+      y = ty  << DIRTY_TILE_SHIFT;
+      w = std::min<uint_fast16_t>((tx1 + 1) << DIRTY_TILE_SHIFT, _panel_width ) - x;
+      h = std::min<uint_fast16_t>((ty1 + 1) << DIRTY_TILE_SHIFT, _panel_height) - y;
+      return true;
+    }
+    return false;
+  }
+
+//----------------------------------------------------------------------------
+
+  void LGFX_Sprite::push_sprite_rect(LovyanGFX* dst, int32_t x, int32_t y, const int32_t clip[4], int32_t rx, int32_t ry, int32_t rw, int32_t rh, uint32_t transp)
+  {
+    // 転送先のクリップ範囲をスプライト上の矩形に絞って、通常のpushSpriteで送る
+    int32_t l = std::max<int32_t>(clip[0], x + rx);
+    int32_t t = std::max<int32_t>(clip[1], y + ry);
+    int32_t r = std::min<int32_t>(clip[0] + clip[2], x + rx + rw);
+    int32_t b = std::min<int32_t>(clip[1] + clip[3], y + ry + rh);
+    if (l >= r || t >= b) { return; }
+    dst->setClipRect(l, t, r - l, b - t);
+    push_sprite(dst, x, y, transp);
+  }
+
+  void LGFX_Sprite::push_sprite_dirty(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp)
+  {
+    auto panel = sprite_panel();
+    if (!panel->getDirtyTracking())
+    {
+      push_sprite(dst, x, y, transp);
+      return;
+    }
+
+    int32_t clip[4];
+    dst->getClipRect(&clip[0], &clip[1], &clip[2], &clip[3]);
+    dst->startWrite();
+    uint_fast16_t rx, ry, rw, rh;
+    while (panel->popDirtyRect(rx, ry, rw, rh))
+    {
+      push_sprite_rect(dst, x, y, clip, rx, ry, rw, rh, transp);
+    }
+    dst->setClipRect(clip[0], clip[1], clip[2], clip[3]);
+    dst->endWrite();
+  }
+
+  void LGFX_Sprite::push_sprite_diff(LovyanGFX* dst, int32_t x, int32_t y, const LGFX_Sprite* prev, sprite_diff_stats_t* stats)
+  {
+    auto panel = sprite_panel();
+    int32_t pw = panel->_panel_width;
+    int32_t ph = panel->_panel_height;
+    uint32_t bits = _write_conv.bits;
+    uint32_t dst_bits = dst->getColorDepth() & color_depth_t::bit_mask;
+    uint32_t line_bytes = panel->_bitwidth * bits >> 3;
+    uint32_t frame_bytes = (pw * dst_bits * ph + 7) >> 3;
+    uint32_t sent = 0;
+    uint32_t rects = 0;
+
+    auto prev_panel = prev ? prev->sprite_panel() : nullptr;
+    if (!prev_panel || !_img || !prev->_img
+     || prev_panel->_panel_width != panel->_panel_width || prev_panel->_panel_height != panel->_panel_height
+     || prev->getColorDepth() != getColorDepth())
+    { // 比較できない場合は全体を送る
+      push_sprite(dst, x, y);
+      sent = frame_bytes;
+      rects = 1;
+    }
+    else
+    {
+      // 窓設定のコマンドより短い隙間は詰めずに一続きとして送る (転送先の形式でのバイト数)
+      static constexpr uint32_t GAP_BYTES = 8;
+      uint32_t gap = std::max<uint32_t>(1, GAP_BYTES * bits / dst_bits);
+      int32_t clip[4];
+      dst->getClipRect(&clip[0], &clip[1], &clip[2], &clip[3]);
+      dst->startWrite();
+
+      // 直前の行と同じ範囲が変化している間は縦に延ばして1つの矩形として送る
+      int32_t run_x = 0, run_w = 0, run_y = 0, run_h = 0;
+      auto flush = [&](void)
+      {
+        if (!run_h) { return; }
+        push_sprite_rect(dst, x, y, clip, run_x, run_y, run_w, run_h);
+        sent += (run_w * dst_bits * run_h + 7) >> 3;
+        ++rects;
+        run_h = 0;
+      };
+
+      auto a = static_cast<const uint8_t*>(_img);
+      auto b = static_cast<const uint8_t*>(prev->_img);
+      for (int32_t py = 0; py < ph; ++py, a += line_bytes, b += line_bytes)
+      {
+        if (0 == memcmp(a, b, line_bytes)) { flush(); continue; }
+
+        uint32_t runs = 0;
+        uint32_t i = 0;
+        while (i < line_bytes)
+        {
+          // 4バイト単位で一致する部分を読み飛ばす
+          for (; i + 4 <= line_bytes; i += 4)
+          {
+            uint32_t wa, wb;
+            memcpy(&wa, &a[i], 4);
+            memcpy(&wb, &b[i], 4);
+            if (wa != wb) { break; }
+          }
+          while (i < line_bytes && a[i] == b[i]) { ++i; }
+          if (i >= line_bytes) { break; }
+
+          uint32_t first = i;
+          uint32_t last = i;
+          uint32_t same = 0;
+          for (++i; i < line_bytes && same < gap; ++i)
+          {
+            if (a[i] != b[i]) { last = i; same = 0; }
+            else { ++same; }
+          }
+          i = last + 1;
+
+          int32_t x0 = (first << 3) / bits;
+          int32_t x1 = std::min<int32_t>(pw - 1, (((last + 1) << 3) - 1) / bits);
+          if (x0 > x1) { continue; }
+          int32_t mx0 = std::min<int32_t>(run_x, x0);
+          int32_t mx1 = std::max<int32_t>(run_x + run_w - 1, x1);
+          // 矩形を広げて増える転送量が窓設定の手間より小さければ縦に延ばす
+          if (runs == 0 && run_h && run_y + run_h == py
+           && ((((mx1 - mx0 + 1) * (run_h + 1) - run_w * run_h - (x1 - x0 + 1)) * dst_bits) >> 3) <= GAP_BYTES)
+          {
+            run_x = mx0;
+            run_w = mx1 - mx0 + 1;
+            ++run_h;
+          }
+          else
+          {
+            flush();
+            run_x = x0;
+            run_w = x1 - x0 + 1;
+            run_y = py;
+            run_h = 1;
+          }
+          ++runs;
+        }
+        // 1行に複数の範囲がある場合は縦方向にまとめない
+        if (runs > 1) { flush(); }
+      }
+      flush();
+      dst->setClipRect(clip[0], clip[1], clip[2], clip[3]);
+      dst->endWrite();
+    }
+
+    if (stats)
+    {
+      stats->frame_bytes = frame_bytes;
+      stats->sent_bytes = sent;
+      stats->saved_bytes = frame_bytes - sent;
+      stats->rects = rects;
+    }
+  }
+
 //----------------------------------------------------------------------------
 
   bool LGFX_Sprite::create_from_bmp_file(DataWrapper* data, const char *path) {
@@ -728,7 +1027,7 @@ namespace lgfx
 
     data->seek(seekOffset);
 
-    auto bitwidth = _panel_sprite._bitwidth;
+    auto bitwidth = sprite_panel()->_bitwidth;
 
     size_t buffersize = ((w * bpp + 31) >> 5) << 2;  // readline 4Byte align.
     auto lineBuffer = (uint8_t*)alloca(buffersize);
@@ -781,6 +1080,186 @@ namespace lgfx
     return true;
   }
 
+#if defined ( __linux__ ) || defined ( __APPLE__ ) || defined ( _WIN32 )
+
+  // スレッドごとのデコード状態。入力はメモリ上のデータを独立した位置から読む
+  struct jpg_stripe_t
+  {
+    const uint8_t* data;
+    uint32_t length;
+    uint32_t pos;
+    uint32_t rst_pos;     // 担当する最初のリスタート区間の符号データの位置
+    uint32_t ri_start;
+    uint32_t ri_end;
+    uint8_t* pool;
+    Panel_Sprite* panel;
+    pixelcopy_t pc;
+    uint8_t format;       // デコーダの出力形式 (JD_FMT_*)
+    int32_t x, y;
+    int32_t clip_l, clip_t, clip_r, clip_b;
+    JRESULT result;
+  };
+
+  static constexpr uint16_t jpg_stripe_pool_size = 3900;
+
+  static uint32_t jpg_stripe_read(void* self, uint8_t* buf, uint32_t len)
+  {
+    auto s = static_cast<jpg_stripe_t*>(self);
+    uint32_t remain = s->length - s->pos;
+    if (len > remain) { len = remain; }
+    if (buf) { memcpy(buf, &s->data[s->pos], len); }
+    s->pos += len;
+    return len;
+  }
+
+  // LGFXBase::pushImageと同じクリッピングを行い、パネルへ直接書込む。
+  // startWrite/endWriteのカウンタは共有されるため、ワーカーからは呼ばない
+  static uint32_t jpg_stripe_write(void* self, void* bitmap, JRECT* rect)
+  {
+    auto s = static_cast<jpg_stripe_t*>(self);
+    int32_t w = rect->right  - rect->left + 1;
+    int32_t h = rect->bottom - rect->top + 1;
+    int32_t x = s->x + rect->left;
+    int32_t y = s->y + rect->top;
+    int32_t dx = 0, dy = 0;
+    if (x < s->clip_l) { dx = s->clip_l - x; x = s->clip_l; }
+    if (y < s->clip_t) { dy = s->clip_t - y; y = s->clip_t; }
+    int32_t dw = std::min(w, s->clip_r - x + 1 + dx) - dx;
+    int32_t dh = std::min(h, s->clip_b - y + 1 + dy) - dy;
+    if (dw <= 0 || dh <= 0) { return 1; }
+
+    auto pc = &s->pc;
+    pc->src_data = bitmap;
+    pc->src_bitwidth = w;
+    pc->src_x32_add = 1 << pixelcopy_t::FP_SCALE;
+    pc->src_y32_add = 0;
+    pc->src_x32 = dx << pixelcopy_t::FP_SCALE;
+    pc->src_y32 = dy << pixelcopy_t::FP_SCALE;
+    s->panel->writeImage(x, y, dw, dh, pc, false);
+    return 1;
+  }
+
+  static void jpg_stripe_decode(jpg_stripe_t* s, uint_fast8_t div)
+  {
+    lgfxJdec jd;
+    s->pos = 0;
+    s->result = lgfx_jd_prepare(&jd, jpg_stripe_read, s->pool, jpg_stripe_pool_size, s);
+    if (s->result != JDR_OK) { return; }
+    jd.format = s->format;
+    s->pos = s->rst_pos;
+    s->result = lgfx_jd_decomp_rst(&jd, jpg_stripe_write, div, s->ri_start, s->ri_end);
+  }
+
+  bool LGFX_Sprite::drawJpgParallel(const uint8_t* jpg_data, uint32_t jpg_len, int32_t x, int32_t y, uint_fast8_t threads, float scale)
+  {
+    uint_fast8_t div = 0;
+    while (div < 4 && scale != 1.0f / (1 << div)) { ++div; }
+    if (threads == 0) { threads = std::min<unsigned>(UINT8_MAX, std::thread::hardware_concurrency()); }
+    if (div > 3 || threads < 2 || _img == nullptr || _write_conv.bits < 8 || jpg_data == nullptr)
+    { // 1Byte未満の画素は隣接するMCUの書込みが同じバイトに重なるため、並列化しない
+      return drawJpg(jpg_data, jpg_len, x, y, 0, 0, 0, 0, scale, scale);
+    }
+
+    auto pool = static_cast<uint8_t*>(buffer_alloc(jpg_stripe_pool_size * threads, AllocationSource::Normal));
+    if (pool == nullptr) { return false; }
+
+    jpg_stripe_t head;
+    head.data = jpg_data;
+    head.length = jpg_len;
+    head.pos = 0;
+    lgfxJdec jd;
+    if (JDR_OK != lgfx_jd_prepare(&jd, jpg_stripe_read, pool, jpg_stripe_pool_size, &head))
+    {
+      buffer_free(pool);
+      return false;
+    }
+    uint32_t intervals = 0;
+    if (!jd.progressive && jd.nrst)
+    {
+      intervals = ((uint32_t)jd.mcux * jd.mcuy + jd.nrst - 1) / jd.nrst;
+    }
+    if (threads > intervals) { threads = intervals; }
+
+    // 各リスタート区間の符号データの開始位置を RSTn マーカから求める
+    std::vector<uint32_t> rst_pos;
+    if (threads >= 2)
+    {
+      rst_pos.resize(intervals);
+      rst_pos[0] = head.pos - (jd.dpend - jd.dptr - 1); // 先読みされた分を戻す
+      uint32_t k = 1;
+      for (uint32_t i = rst_pos[0]; k < intervals && i + 1 < jpg_len; ++i)
+      {
+        if (jpg_data[i] != 0xFF) { continue; }
+        uint_fast8_t m = jpg_data[i + 1];
+        if (m == 0xFF) { continue; }  // fill byte
+        ++i;
+        if (m == 0) { continue; }     // stuffed 0xFF
+        if ((m & 0xF8) != 0xD0) { break; }
+        rst_pos[k++] = i + 1;
+      }
+      if (k < intervals) { threads = 0; }
+    }
+
+    if (threads < 2)
+    {
+      buffer_free(pool);
+      return drawJpg(jpg_data, jpg_len, x, y, 0, 0, 0, 0, scale, scale);
+    }
+
+    _jpg_peak_memory = jpg_stripe_pool_size * threads;
+
+    // ワーカーが変更タイルのビットマップを同時に更新しないよう、デコード中は取り外しておき
+    // 全スレッドの終了後に出力範囲をまとめて変更済みにする
+    SpriteBuffer dirty;
+    sprite_panel()->_dirty.swap(dirty);
+
+    // 16bit出力先ではデコーダが直接 swap565 を出力する
+    bool swap565 = getColorDepth() == rgb565_2Byte;
+
+    std::vector<jpg_stripe_t> stripes(threads);
+    for (uint32_t t = 0; t < threads; ++t)
+    {
+      auto s = &stripes[t];
+      s->data = jpg_data;
+      s->length = jpg_len;
+      s->ri_start = intervals * t / threads;
+      s->ri_end = intervals * (t + 1) / threads;
+      s->rst_pos = rst_pos[s->ri_start];
+      s->pool = &pool[jpg_stripe_pool_size * t];
+      s->panel = sprite_panel();
+      s->pc = pixelcopy_t(nullptr, getColorDepth(), swap565 ? swap565_t::depth : bgr888_t::depth, hasPalette());
+      s->format = swap565 ? JD_FMT_SWAP565 : JD_FMT_RGB888;
+      s->x = x;
+      s->y = y;
+      s->clip_l = _clip_l;
+      s->clip_t = _clip_t;
+      s->clip_r = _clip_r;
+      s->clip_b = _clip_b;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (uint32_t t = 1; t < threads; ++t)
+    {
+      workers.emplace_back(jpg_stripe_decode, &stripes[t], div);
+    }
+    jpg_stripe_decode(&stripes[0], div);
+    bool res = stripes[0].result == JDR_OK;
+    for (uint32_t t = 1; t < threads; ++t)
+    {
+      workers[t - 1].join();
+      res &= stripes[t].result == JDR_OK;
+    }
+
+    sprite_panel()->_dirty.swap(dirty);
+    markDirty(x, y, (jd.width + (1 << div) - 1) >> div, (jd.height + (1 << div) - 1) >> div);
+
+    buffer_free(pool);
+    return res;
+  }
+
+#endif
+
 //----------------------------------------------------------------------------
  }
 }
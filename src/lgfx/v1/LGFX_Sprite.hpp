@@ -79,6 +79,7 @@ namespace lgfx
     void setWindow(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye) override;
     void drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override;
     void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t raw_color) override;
+    void writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t raw_color) override;
     void writeBlock(uint32_t rawcolor, uint32_t len) override;
     void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
     void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool) override;
@@ -89,7 +90,22 @@ namespace lgfx
 
     uint32_t readPixelValue(uint_fast16_t x, uint_fast16_t y);
 
+    // 描画で変更された16x16ドットのタイルを記録する (既定は無効)
+/// Enables or disables tracking of modified 16x16 tiles. Tiles are kept in unrotated buffer coordinates.
+    void setDirtyTracking(bool enable);
+    LGFX_INLINE bool getDirtyTracking(void) const { return _dirty_tracking; }
+/// Marks an area given in rotated (drawing) coordinates as modified, e.g. after writing to getBuffer() directly.
+    LGFX_INLINE void markDirty(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) { if (_dirty) { _mark_dirty(x, y, w, h); } }
+    void clearDirty(void);
+/// Takes the next modified rectangle (unrotated buffer coordinates) and clears its tiles. Returns false when nothing is left.
+    bool popDirtyRect(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h);
+
+    static constexpr uint_fast8_t DIRTY_TILE_SHIFT = 4;
+
   protected:
+    void _mark_dirty(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h);
+    void _reset_dirty(void);
+
     void _rotate_pixelcopy(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h, pixelcopy_t* param, uint32_t& nextx, uint32_t& nexty);
 
     SpriteBuffer _img;
@@ -99,6 +115,140 @@ namespace lgfx
     uint_fast16_t _panel_width;   // rotationしていない状態の幅;
     uint_fast16_t _panel_height;  // rotationしていない状態の高さ;
     uint_fast16_t _bitwidth;
+
+    SpriteBuffer _dirty;           // 変更タイルのビットマップ (1タイル1ビット、行ごとに_dirty_strideワード);
+    uint_fast16_t _dirty_stride = 0;
+    bool _dirty_tracking = false;
+  };
+
+//----------------------------------------------------------------------------
+
+  // 色深度ごとの画素の格納型と読出し用の色型
+  template <uint8_t Bits> struct sprite_pixel_traits;
+  template <> struct sprite_pixel_traits< 8> { using store_t = uint8_t;  using color_t = rgb332_t;   };
+  template <> struct sprite_pixel_traits<16> { using store_t = uint16_t; using color_t = swap565_t;  };
+  template <> struct sprite_pixel_traits<24> { using store_t = bgr888_t; using color_t = bgr888_t;   };
+  template <> struct sprite_pixel_traits<32> { using store_t = uint32_t; using color_t = bgra8888_t; };
+
+/// Panel_Sprite specialised at compile time for one colour depth.
+/// While the rotation is 0 and the sprite keeps that depth, pixel, fill and same-depth image writes
+/// run as typed loops without per-call depth branches or fp_copy dispatch; otherwise it behaves as Panel_Sprite.
+  template <color_depth_t Depth>
+  struct Panel_SpriteT : public Panel_Sprite
+  {
+    static constexpr uint8_t bits = Depth & color_depth_t::bit_mask;
+    static_assert(bits == 8 || bits == 16 || bits == 24 || bits == 32, "Panel_SpriteT supports 8, 16, 24 and 32 bit depths");
+    using store_t = typename sprite_pixel_traits<bits>::store_t;
+    using color_t = typename sprite_pixel_traits<bits>::color_t;
+
+    color_depth_t setColorDepth(color_depth_t depth) override
+    {
+      depth = Panel_Sprite::setColorDepth(depth);
+      _update_fast_path();
+      return depth;
+    }
+
+    void setRotation(uint_fast8_t r) override
+    {
+      Panel_Sprite::setRotation(r);
+      _update_fast_path();
+    }
+
+    void drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override
+    {
+      if (!_fast_path) { Panel_Sprite::drawPixelPreclipped(x, y, rawcolor); return; }
+      if (_dirty) { _mark_dirty(x, y, 1, 1); }
+      _pixels()[x + y * _bitwidth] = rawcolor;
+    }
+
+    void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override
+    {
+      if (!_fast_path) { Panel_Sprite::writeFillRectPreclipped(x, y, w, h, rawcolor); return; }
+      if (_dirty) { _mark_dirty(x, y, w, h); }
+      _fill_rect(x, y, w, h, rawcolor);
+    }
+
+    void writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t rawcolor) override
+    {
+      if (!_fast_path) { Panel_Sprite::writeFillRectsPreclipped(rects, count, rawcolor); return; }
+      for (size_t i = 0; i < count; ++i)
+      {
+        auto& r = rects[i];
+        if (_dirty) { _mark_dirty(r.x, r.y, r.w, r.h); }
+        _fill_rect(r.x, r.y, r.w, r.h, rawcolor);
+      }
+    }
+
+    void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override
+    {
+      // 同じ色深度・等倍の転送のみ型付きループで処理する。透過なしでmemcpyが使える場合は基底の処理に任せる
+      if (!_fast_path || !param->no_convert
+       || param->src_x32_add != (1u << pixelcopy_t::FP_SCALE) || param->src_y32_add != 0
+       || (param->transp == pixelcopy_t::NON_TRANSP && _img.use_memcpy()))
+      {
+        Panel_Sprite::writeImage(x, y, w, h, param, use_dma);
+        return;
+      }
+      if (_dirty) { _mark_dirty(x, y, w, h); }
+      uint_fast16_t bw = _bitwidth;
+      uint_fast16_t sw = param->src_bitwidth;
+      auto dst = &_pixels()[x + y * bw];
+      auto src = &static_cast<const color_t*>(param->src_data)[param->src_x + param->src_y * sw];
+      uint32_t transp = param->transp;
+      do
+      {
+        for (uint_fast16_t i = 0; i < w; ++i)
+        {
+          uint32_t raw = src[i].get();
+          if (raw != transp) { dst[i] = raw; }
+        }
+        dst += bw;
+        src += sw;
+      } while (--h);
+    }
+
+    LGFX_INLINE store_t* getPixelBuffer(void) const { return _pixels(); }
+
+  protected:
+    bool _fast_path = false;
+
+    LGFX_INLINE store_t* _pixels(void) const { return reinterpret_cast<store_t*>(_img.get()); }
+
+    void _update_fast_path(void) { _fast_path = (_write_bits == bits) && (_rotation == 0); }
+
+    void _fill_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
+    {
+      uint_fast16_t bw = _bitwidth;
+      auto dst = &_pixels()[x + y * bw];
+      if (w == bw)
+      { // 全幅の場合は1本の連続領域として塗る
+        w *= h;
+        h = 1;
+      }
+      store_t c = rawcolor;
+      bool use_memset = (bits == 8) && _img.use_memcpy();
+      do
+      {
+        if (use_memset)
+        {
+          memset(dst, rawcolor, w);
+        }
+        else
+        {
+          for (uint_fast32_t i = 0; i < w; ++i) { dst[i] = c; }
+        }
+        dst += bw;
+      } while (--h);
+    }
+  };
+
+/// Result of LGFX_Sprite::pushSpriteDiff(). Byte counts are pixel data in the destination format, excluding panel commands.
+  struct sprite_diff_stats_t
+  {
+    uint32_t frame_bytes;  // 全体を送った場合のバイト数;
+    uint32_t sent_bytes;   // 実際に送ったバイト数;
+    uint32_t saved_bytes;  // frame_bytes - sent_bytes;
+    uint32_t rects;        // 送った矩形の数;
   };
 
   class LGFX_Sprite : public LovyanGFX
@@ -115,8 +265,11 @@ namespace lgfx
     }
 
     LGFX_INLINE LovyanGFX* getParent(void) const { return _parent; }
-    LGFX_INLINE void* getBuffer(void) const { return _panel_sprite.getBuffer(); }
-    uint32_t bufferLength(void) const { return _panel_sprite.bufferLength(); }
+    LGFX_INLINE void* getBuffer(void) const { return sprite_panel()->getBuffer(); }
+    uint32_t bufferLength(void) const { return sprite_panel()->bufferLength(); }
+/// Size of the buffer returned by getBuffer(). Unlike width()/height() these ignore setRotation.
+    LGFX_INLINE uint32_t buffer_width(void) const { return sprite_panel()->_panel_width; }
+    LGFX_INLINE uint32_t buffer_height(void) const { return sprite_panel()->_panel_height; }
 
     LGFX_Sprite()
     : LGFX_Sprite(nullptr)
@@ -141,7 +294,7 @@ namespace lgfx
       _clip_r = -1;
       _clip_b = -1;
 
-      _panel_sprite.deleteSprite();
+      sprite_panel()->deleteSprite();
       _img = nullptr;
     }
 
@@ -157,8 +310,8 @@ namespace lgfx
       deleteSprite();
       if (bpp != 0) _write_conv.setColorDepth((color_depth_t)bpp, hasPalette());
 
-      _panel_sprite.setBuffer(buffer, w, h, &_write_conv);
-      _img = _panel_sprite.getBuffer();
+      sprite_panel()->setBuffer(buffer, w, h, &_write_conv);
+      _img = sprite_panel()->getBuffer();
 
       _sw = w;
       _clip_r = w - 1;
@@ -171,7 +324,7 @@ namespace lgfx
 
     void* createSprite(int32_t w, int32_t h)
     {
-      _img = _panel_sprite.createSprite(w, h, &_write_conv, _psram);
+      _img = sprite_panel()->createSprite(w, h, &_write_conv, _psram);
       if (_img) {
         if (getColorDepth() & color_depth_t::has_palette)
         {
@@ -315,17 +468,57 @@ namespace lgfx
       _write_conv.setColorDepth(depth);
       _read_conv = _write_conv;
 
-      _panel_sprite.setColorDepth(_write_conv.depth);
+      sprite_panel()->setColorDepth(_write_conv.depth);
 
-      if (_panel_sprite.getBuffer() == nullptr) return nullptr;
-      auto w = _panel_sprite._panel_width;
-      auto h = _panel_sprite._panel_height;
+      if (sprite_panel()->getBuffer() == nullptr) return nullptr;
+      auto w = sprite_panel()->_panel_width;
+      auto h = sprite_panel()->_panel_height;
       deleteSprite();
       deletePalette();
       return createSprite(w, h);
     }
 
-    uint32_t readPixelValue(int32_t x, int32_t y) { return _panel_sprite.readPixelValue(x, y); }
+    uint32_t readPixelValue(int32_t x, int32_t y) { return sprite_panel()->readPixelValue(x, y); }
+
+/// Enables tracking of modified 16x16 tiles. pushSpriteDirty() then sends only the modified area.
+    void setDirtyTracking(bool enable) { sprite_panel()->setDirtyTracking(enable); }
+    bool getDirtyTracking(void) const { return sprite_panel()->getDirtyTracking(); }
+/// Marks an area as modified. Needed only after writing to getBuffer() directly.
+    void markDirty(int32_t x, int32_t y, int32_t w, int32_t h)
+    {
+      if (x < 0) { w += x; x = 0; }
+      if (y < 0) { h += y; y = 0; }
+      if (w > width()  - x) { w = width()  - x; }
+      if (h > height() - y) { h = height() - y; }
+      if (w > 0 && h > 0) { sprite_panel()->markDirty(x, y, w, h); }
+    }
+    void clearDirty(void) { sprite_panel()->clearDirty(); }
+
+    // 変更されたタイルのみを転送し、変更記録を消去する (記録が無効な場合は全体を転送する)
+    template<typename T>
+    LGFX_INLINE void pushSpriteDirty(                int32_t x, int32_t y, const T& transp) { push_sprite_dirty(_parent, x, y, _write_conv.convert(transp) & _write_conv.colormask); }
+    template<typename T>
+    LGFX_INLINE void pushSpriteDirty(LovyanGFX* dst, int32_t x, int32_t y, const T& transp) { push_sprite_dirty(    dst, x, y, _write_conv.convert(transp) & _write_conv.colormask); }
+    LGFX_INLINE void pushSpriteDirty(                int32_t x, int32_t y) { push_sprite_dirty(_parent, x, y); }
+    LGFX_INLINE void pushSpriteDirty(LovyanGFX* dst, int32_t x, int32_t y) { push_sprite_dirty(    dst, x, y); }
+
+    // 前フレームのスプライトと比較し、変化した範囲のみを転送する
+/// Sends only the parts that differ from prev, a sprite of the same size and depth holding what is already on screen.
+/// The rows are compared word by word. Rows whose changed range is the same are merged into one rectangle.
+/// If the sprites cannot be compared, the whole sprite is sent.
+    LGFX_INLINE void pushSpriteDiff(                int32_t x, int32_t y, const LGFX_Sprite* prev, sprite_diff_stats_t* stats = nullptr) { push_sprite_diff(_parent, x, y, prev, stats); }
+    LGFX_INLINE void pushSpriteDiff(LovyanGFX* dst, int32_t x, int32_t y, const LGFX_Sprite* prev, sprite_diff_stats_t* stats = nullptr) { push_sprite_diff(    dst, x, y, prev, stats); }
+
+#if defined ( __linux__ ) || defined ( __APPLE__ ) || defined ( _WIN32 )
+    // リスタートマーカ(DRI)を含むベースラインJPEGを、リスタート区間単位で複数スレッドに分けてデコードする。
+    // 各スレッドは担当するMCU行の帯を直接このスプライトに書込む
+/// Decodes a baseline JPEG held in memory on several threads. The restart intervals (DRI) are split into
+/// consecutive stripes of MCU rows; each worker decodes its stripe with its own decoder and writes it into
+/// this sprite. threads = 0 uses all hardware threads; scale must be 1, 1/2, 1/4 or 1/8.
+/// Images without restart markers, progressive images, other scales and sprites under 8 bits per pixel
+/// are drawn by drawJpg on the calling thread.
+    bool drawJpgParallel(const uint8_t* jpg_data, uint32_t jpg_len, int32_t x = 0, int32_t y = 0, uint_fast8_t threads = 0, float scale = 1.0f);
+#endif
 
     template<typename T>
     LGFX_INLINE void fillSprite (const T& color) { fillScreen(color); }
@@ -381,6 +574,11 @@ namespace lgfx
   protected:
 
     Panel_Sprite _panel_sprite;
+
+    // 派生クラスが別のPanel_Spriteを_panelに設定する場合があるため、常に_panel経由で参照する
+    LGFX_INLINE Panel_Sprite* sprite_panel(void) const { return static_cast<Panel_Sprite*>(_panel); }
+
+    LGFX_INLINE uint32_t buffer_bitwidth(void) const { return sprite_panel()->_bitwidth; }
     union
     {
       void* _img;
@@ -410,7 +608,7 @@ namespace lgfx
         auto depth = (color_depth_t)(_write_conv.bits | color_depth_t::has_palette);
         _write_conv.setColorDepth(depth);
         _read_conv = _write_conv;
-        _panel_sprite.setColorDepth(depth);
+        sprite_panel()->setColorDepth(depth);
       }
       _palette_count = palettes;
       return true;
@@ -421,32 +619,68 @@ namespace lgfx
     void push_sprite(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp = pixelcopy_t::NON_TRANSP)
     {
       pixelcopy_t p(_img, dst->getColorDepth(), getColorDepth(), dst->hasPalette(), _palette, transp);
-      dst->pushImage(x, y, _panel_sprite._panel_width, _panel_sprite._panel_height, &p, _panel_sprite.getSpriteBuffer()->use_dma()); // DMA disable with use SPIRAM
+      dst->pushImage(x, y, sprite_panel()->_panel_width, sprite_panel()->_panel_height, &p, sprite_panel()->getSpriteBuffer()->use_dma()); // DMA disable with use SPIRAM
     }
 
+    void push_sprite_rect(LovyanGFX* dst, int32_t x, int32_t y, const int32_t clip[4], int32_t rx, int32_t ry, int32_t rw, int32_t rh, uint32_t transp = pixelcopy_t::NON_TRANSP);
+    void push_sprite_dirty(LovyanGFX* dst, int32_t x, int32_t y, uint32_t transp = pixelcopy_t::NON_TRANSP);
+    void push_sprite_diff(LovyanGFX* dst, int32_t x, int32_t y, const LGFX_Sprite* prev, sprite_diff_stats_t* stats);
+
     void push_rotate_zoom(LovyanGFX* dst, float x, float y, float angle, float zoom_x, float zoom_y, uint32_t transp = pixelcopy_t::NON_TRANSP)
     {
-      dst->pushImageRotateZoom(x, y, _xpivot, _ypivot, angle, zoom_x, zoom_y, _panel_sprite._panel_width, _panel_sprite._panel_height, _img, transp, getColorDepth(), _palette.img24());
+      dst->pushImageRotateZoom(x, y, _xpivot, _ypivot, angle, zoom_x, zoom_y, sprite_panel()->_panel_width, sprite_panel()->_panel_height, _img, transp, getColorDepth(), _palette.img24());
     }
 
     void push_rotate_zoom_aa(LovyanGFX* dst, float x, float y, float angle, float zoom_x, float zoom_y, uint32_t transp = pixelcopy_t::NON_TRANSP)
     {
-      dst->pushImageRotateZoomWithAA(x, y, _xpivot, _ypivot, angle, zoom_x, zoom_y, _panel_sprite._panel_width, _panel_sprite._panel_height, _img, transp, getColorDepth(), _palette.img24());
+      dst->pushImageRotateZoomWithAA(x, y, _xpivot, _ypivot, angle, zoom_x, zoom_y, sprite_panel()->_panel_width, sprite_panel()->_panel_height, _img, transp, getColorDepth(), _palette.img24());
     }
 
     void push_affine(LovyanGFX* dst, const float matrix[6], uint32_t transp = pixelcopy_t::NON_TRANSP)
     {
-      dst->pushImageAffine(matrix, _panel_sprite._panel_width, _panel_sprite._panel_height, _img, transp, getColorDepth(), _palette.img24());
+      dst->pushImageAffine(matrix, sprite_panel()->_panel_width, sprite_panel()->_panel_height, _img, transp, getColorDepth(), _palette.img24());
     }
 
     void push_affine_aa(LovyanGFX* dst, const float matrix[6], uint32_t transp = pixelcopy_t::NON_TRANSP)
     {
-      dst->pushImageAffineWithAA(matrix, _panel_sprite._panel_width, _panel_sprite._panel_height, _img, transp, getColorDepth(), _palette.img24());
+      dst->pushImageAffineWithAA(matrix, sprite_panel()->_panel_width, sprite_panel()->_panel_height, _img, transp, getColorDepth(), _palette.img24());
     }
 
     RGBColor* getPalette_impl(void) const override { return _palette.img24(); }
   };
 
+//----------------------------------------------------------------------------
+
+/// LGFX_Sprite whose panel is specialised at compile time for one colour depth, e.g. LGFX_SpriteT<rgb565_2Byte>.
+/// It is still an LGFX_Sprite; changing the depth or rotation falls back to the generic Panel_Sprite paths.
+  template <color_depth_t Depth>
+  class LGFX_SpriteT : public LGFX_Sprite
+  {
+  public:
+    LGFX_SpriteT(LovyanGFX* parent)
+    : LGFX_Sprite(parent)
+    {
+      _panel = &_panel_sprite_t;
+      setColorDepth(Depth);
+    }
+
+    LGFX_SpriteT()
+    : LGFX_SpriteT(nullptr)
+    {}
+
+    virtual ~LGFX_SpriteT()
+    {
+      deleteSprite();
+      // 基底のデストラクタが破棄済みの_panel_sprite_tを参照しないよう戻しておく
+      _panel = &_panel_sprite;
+    }
+
+    LGFX_INLINE typename Panel_SpriteT<Depth>::store_t* getPixelBuffer(void) const { return _panel_sprite_t.getPixelBuffer(); }
+
+  protected:
+    Panel_SpriteT<Depth> _panel_sprite_t;
+  };
+
 //----------------------------------------------------------------------------
 #undef LGFX_INLINE
 
@@ -454,3 +688,5 @@ namespace lgfx
 }
 
 using LGFX_Sprite = lgfx::LGFX_Sprite;
+template <lgfx::color_depth_t Depth>
+using LGFX_SpriteT = lgfx::LGFX_SpriteT<Depth>;
@@ -0,0 +1,147 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+
+#include "LGFX_SpriteAtlas.hpp"
+
+#include "misc/common_function.hpp"
+
+#include <string.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  int32_t LGFX_SpriteAtlas::addSubImage(int32_t w, int32_t h)
+  {
+    if (_img == nullptr || w < 1 || h < 1 || _count == UINT16_MAX) { return -1; }
+    int32_t aw = buffer_width();
+    int32_t ah = buffer_height();
+    if (w > aw) { return -1; }
+
+    int32_t x = _shelf_x;
+    int32_t y = _shelf_y;
+    if (x + w > aw)
+    { // 現在の段に入らなければ次の段へ移る
+      x = 0;
+      y += _shelf_h;
+      if (y + h > ah) { return -1; }
+      _shelf_y = y;
+      _shelf_h = 0;
+    }
+    else if (y + h > ah) { return -1; }
+
+    if (_count == _capacity)
+    {
+      uint32_t cap = _capacity ? _capacity * 2 : 16;
+      if (cap > UINT16_MAX) { cap = UINT16_MAX; }
+      auto rects = static_cast<rect_t*>(heap_alloc(cap * sizeof(rect_t)));
+      if (rects == nullptr) { return -1; }
+      if (_rects)
+      {
+        memcpy(rects, _rects, _count * sizeof(rect_t));
+        heap_free(_rects);
+      }
+      _rects = rects;
+      _capacity = cap;
+    }
+
+    _shelf_x = x + w;
+    if (_shelf_h < h) { _shelf_h = h; }
+
+    auto r = &_rects[_count];
+    r->x = x;
+    r->y = y;
+    r->w = w;
+    r->h = h;
+    return _count++;
+  }
+
+  int32_t LGFX_SpriteAtlas::addSubImage(LGFX_Sprite* src)
+  {
+    if (src == nullptr || src->getBuffer() == nullptr) { return -1; }
+    int32_t id = addSubImage(src->buffer_width(), src->buffer_height());
+    if (id >= 0) { src->pushSprite(this, _rects[id].x, _rects[id].y); }
+    return id;
+  }
+
+  void LGFX_SpriteAtlas::clearSubImages(void)
+  {
+    if (_rects)
+    {
+      heap_free(_rects);
+      _rects = nullptr;
+    }
+    _count = 0;
+    _capacity = 0;
+    _shelf_x = 0;
+    _shelf_y = 0;
+    _shelf_h = 0;
+  }
+
+  void LGFX_SpriteAtlas::push_sub_images(LovyanGFX* dst, const blit_t* list, size_t count, uint32_t transp)
+  {
+    if (dst == nullptr || _img == nullptr || list == nullptr || count == 0) { return; }
+
+    // 描画順を (y, x) で安定ソートする。リストはほぼ整列済みのことが多いので挿入ソートで十分
+    uint32_t* order = nullptr;
+    if (count > 1)
+    {
+      order = static_cast<uint32_t*>(heap_alloc(count * sizeof(uint32_t)));
+    }
+    if (order)
+    {
+      for (size_t i = 0; i < count; ++i)
+      {
+        uint32_t idx = i;
+        auto b = &list[i];
+        size_t j = i;
+        for (; j > 0; --j)
+        {
+          auto a = &list[order[j - 1]];
+          if (a->y < b->y || (a->y == b->y && a->x <= b->x)) { break; }
+          order[j] = order[j - 1];
+        }
+        order[j] = idx;
+      }
+    }
+
+    pixelcopy_t p(_img, dst->getColorDepth(), getColorDepth(), dst->hasPalette(), _palette, transp);
+    p.src_bitwidth = buffer_bitwidth();
+    bool use_dma = sprite_panel()->getSpriteBuffer()->use_dma();
+
+    dst->startWrite();
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto b = &list[order ? order[i] : i];
+      if (b->id >= _count) { continue; }
+      auto r = &_rects[b->id];
+      // 転送先の回転処理で書き換えられるため毎回戻す
+      p.src_x32_add = 1 << pixelcopy_t::FP_SCALE;
+      p.src_y32_add = 0;
+      dst->pushImageRegion(b->x, b->y, r->w, r->h, r->x, r->y, &p, use_dma);
+    }
+    dst->endWrite();
+
+    if (order) { heap_free(order); }
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,117 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "LGFX_Sprite.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+// 多数の小さな画像を1枚のスプライトに詰めて保持し、まとめて描画するためのアトラス。
+// 画像は棚詰め (左から右へ並べ、入らなければ次の段へ) で配置する。
+/// Packs many small images into one sprite buffer with a rectangle index,
+/// and draws lists of them with a single pixelcopy setup and transaction.
+/// The atlas itself is an LGFX_Sprite, so sub-images can also be drawn into directly.
+/// Sub-image rectangles are in buffer coordinates; keep the atlas at rotation 0.
+
+  class LGFX_SpriteAtlas : public LGFX_Sprite
+  {
+  public:
+    struct rect_t
+    {
+      uint16_t x;
+      uint16_t y;
+      uint16_t w;
+      uint16_t h;
+    };
+
+    /// One draw request for pushSubImages: sub-image id and destination position.
+    struct blit_t
+    {
+      int32_t x;
+      int32_t y;
+      uint16_t id;
+    };
+
+    LGFX_SpriteAtlas(LovyanGFX* parent = nullptr) : LGFX_Sprite(parent) {}
+    virtual ~LGFX_SpriteAtlas(void) { clearSubImages(); }
+
+    /// Allocates the atlas buffer and removes all sub-images.
+    void* createAtlas(int32_t w, int32_t h)
+    {
+      clearSubImages();
+      setRotation(0);
+      return createSprite(w, h);
+    }
+
+    /// Reserves a w x h area and returns its id, or -1 when the atlas is full.
+    int32_t addSubImage(int32_t w, int32_t h);
+
+    /// Packs a copy of a sprite (converted to the atlas color depth). The sprite's setRotation is ignored, as in pushSprite.
+    int32_t addSubImage(LGFX_Sprite* src);
+
+    /// Packs a copy of an image.
+    template<typename T>
+    int32_t addSubImage(int32_t w, int32_t h, const T* data)
+    {
+      int32_t id = addSubImage(w, h);
+      if (id >= 0) { pushImage(_rects[id].x, _rects[id].y, w, h, data); }
+      return id;
+    }
+
+    /// Removes all sub-images. The pixels are kept.
+    void clearSubImages(void);
+
+    size_t getSubImageCount(void) const { return _count; }
+    const rect_t* getSubImage(uint16_t id) const { return id < _count ? &_rects[id] : nullptr; }
+
+    template<typename T>
+    void pushSubImage(LovyanGFX* dst, int32_t x, int32_t y, uint16_t id, const T& transp) { blit_t b = { x, y, id }; push_sub_images(dst, &b, 1, _write_conv.convert(transp) & _write_conv.colormask); }
+    void pushSubImage(LovyanGFX* dst, int32_t x, int32_t y, uint16_t id)                  { blit_t b = { x, y, id }; push_sub_images(dst, &b, 1); }
+
+    // 描画先の行順 (y, x) に並べ替えてから描画する。同じ位置の要素はリストの順序を保つ
+    /// Draws a list of sub-images sorted by destination row (y, then x) inside one transaction.
+    /// Items that start at the same position keep their list order.
+    template<typename T>
+    void pushSubImages(LovyanGFX* dst, const blit_t* list, size_t count, const T& transp) { push_sub_images(dst, list, count, _write_conv.convert(transp) & _write_conv.colormask); }
+    void pushSubImages(LovyanGFX* dst, const blit_t* list, size_t count)                  { push_sub_images(dst, list, count); }
+
+  protected:
+    rect_t* _rects = nullptr;
+    uint16_t _count = 0;
+    uint16_t _capacity = 0;
+
+    // 棚詰めの現在位置
+    uint16_t _shelf_x = 0;
+    uint16_t _shelf_y = 0;
+    uint16_t _shelf_h = 0;
+
+    void push_sub_images(LovyanGFX* dst, const blit_t* list, size_t count, uint32_t transp = pixelcopy_t::NON_TRANSP);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
+
+using LGFX_SpriteAtlas = lgfx::LGFX_SpriteAtlas;
@@ -0,0 +1,355 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+
+#include "LGFX_TextRunCache.hpp"
+
+#include "LGFXBase.hpp"
+#include "LGFX_Sprite.hpp"
+
+#include "../internal/algorithm.h"
+
+#include <string.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static uint32_t fnv1a(uint32_t hash, const void* data, size_t length)
+  {
+    auto p = (const uint8_t*)data;
+    while (length--) { hash = (hash ^ *p++) * 16777619u; }
+    return hash;
+  }
+
+  static inline uint32_t load_raw(const uint8_t* p, size_t bytes)
+  {
+    uint32_t res = p[0];
+    if (bytes > 1) { res |= p[1] << 8; }
+    if (bytes > 2) { res |= p[2] << 16; }
+    return res;
+  }
+
+  static inline void store_raw(uint8_t* p, uint32_t raw, size_t bytes)
+  {
+    p[0] = raw;
+    if (bytes > 1) { p[1] = raw >> 8; }
+    if (bytes > 2) { p[2] = raw >> 16; }
+  }
+
+  void LGFX_TextRunCache::setBudget(uint32_t bytes)
+  {
+    _budget = bytes;
+    evict(bytes);
+  }
+
+  void LGFX_TextRunCache::clear(void)
+  {
+    evict(0);
+  }
+
+  void LGFX_TextRunCache::unlink(entry_t* entry)
+  {
+    if (entry->prev) { entry->prev->next = entry->next; } else { _head = entry->next; }
+    if (entry->next) { entry->next->prev = entry->prev; } else { _tail = entry->prev; }
+  }
+
+  void LGFX_TextRunCache::pushFront(entry_t* entry)
+  {
+    entry->prev = nullptr;
+    entry->next = _head;
+    if (_head) { _head->prev = entry; } else { _tail = entry; }
+    _head = entry;
+  }
+
+  void LGFX_TextRunCache::evict(uint32_t limit)
+  {
+    while (_stats.used_bytes > limit && _tail)
+    {
+      auto entry = _tail;
+      unlink(entry);
+      _stats.used_bytes -= entry->size;
+      --_stats.entries;
+      if (limit) { ++_stats.evictions; }
+      heap_free(entry);
+    }
+  }
+
+  bool LGFX_TextRunCache::drawString(LGFXBase* gfx, const char* string, int32_t x, int32_t y, textdatum_t datum, const IFont* font, size_t* width)
+  {
+    if (string == nullptr || _budget == 0) { return false; }
+
+    auto depth = gfx->getColorDepth();
+    if (gfx->hasPalette()
+     || (depth != rgb332_1Byte && depth != rgb565_2Byte && depth != rgb888_3Byte))
+    {
+      ++_stats.bypasses;
+      return false;
+    }
+
+    auto& style = gfx->getTextStyle();
+    key_t key;
+    memset(&key, 0, sizeof(key_t));  // padding bytes take part in the comparison
+    key.font        = font;
+    key.fore_rgb888 = style.fore_rgb888;
+    key.back_rgb888 = style.back_rgb888;
+    key.base_rgb888 = gfx->getBaseColor();
+    key.size_x      = style.size_x;
+    key.size_y      = style.size_y;
+    key.padding_x   = style.padding_x;
+    key.datum       = datum;
+    key.depth       = depth;
+    key.utf8        = style.utf8;
+    key.cp437       = style.cp437;
+
+    size_t length = strlen(string);
+    uint32_t hash = fnv1a(fnv1a(2166136261u, string, length), &key, sizeof(key_t));
+
+    for (auto entry = _head; entry; entry = entry->next)
+    {
+      if (entry->hash == hash
+       && memcmp(&entry->key, &key, sizeof(key_t)) == 0
+       && strcmp(entry->string, string) == 0)
+      {
+        ++_stats.hits;
+        if (entry != _head)
+        {
+          unlink(entry);
+          pushFront(entry);
+        }
+        draw(gfx, entry, x, y);
+        *width = entry->text_width;
+        return true;
+      }
+    }
+
+    auto entry = render(gfx, key, hash, string, length);
+    if (entry == nullptr)
+    {
+      ++_stats.bypasses;
+      return false;
+    }
+    ++_stats.misses;
+    draw(gfx, entry, x, y);
+    *width = entry->text_width;
+
+    if (entry->size > _budget)
+    {
+      heap_free(entry);
+    }
+    else
+    {
+      evict(_budget - entry->size);
+      pushFront(entry);
+      _stats.used_bytes += entry->size;
+      ++_stats.entries;
+    }
+    return true;
+  }
+
+  void LGFX_TextRunCache::draw(LGFXBase* gfx, const entry_t* entry, int32_t x, int32_t y)
+  {
+    if (entry->w <= 0 || entry->h <= 0) { return; }
+    x += entry->dx;
+    y += entry->dy;
+    if (entry->type == image_alpha)
+    {
+      gfx->pushAlphaImage(x, y, entry->w, entry->h, (const bgra8888_t*)entry->image);
+    }
+    else
+    {
+      auto depth = (color_depth_t)entry->key.depth;
+      pixelcopy_t pc(entry->image, depth, depth, false, nullptr
+                    , entry->type == image_keyed ? entry->transp : pixelcopy_t::NON_TRANSP);
+      gfx->pushImage(x, y, entry->w, entry->h, &pc);
+    }
+  }
+
+  // 文字列を2枚のスプライトへ異なる背景で描画し、両者を比較して描画された画素を求める。
+  //  背景に関わらず同じ値 : 描画された画素
+  //  それぞれの背景のまま : 描画されていない画素
+  //  それ以外             : 背景と合成された画素 (アンチエイリアス)
+  auto LGFX_TextRunCache::render(LGFXBase* gfx, const key_t& key, uint32_t hash, const char* string, size_t length) -> entry_t*
+  {
+    auto depth = (color_depth_t)key.depth;
+    bool transparent = key.fore_rgb888 == key.back_rgb888;
+
+    int32_t cw = gfx->textWidth(string, key.font);
+    int32_t ch = gfx->fontHeight(key.font);
+    if (ch <= 0) { return nullptr; }
+    int32_t mw = std::max(cw, key.padding_x);
+    // glyphs may overhang the nominal text box.
+    int32_t margin = (ch >> 1) + 2;
+    int32_t sw = mw + margin * 2;
+    int32_t sh = ch + margin * 2;
+    int32_t ax = margin + ((key.datum & top_center) ? ((mw + 1) >> 1) : (key.datum & top_right) ? mw : 0);
+    int32_t ay = margin + ((key.datum & middle_left) ? ((ch + 1) >> 1) : (key.datum & (bottom_left | baseline_left)) ? ch : 0);
+
+    // 透過描画の場合は合成の度合いを求めるため 24bit で描画する
+    auto sdepth = transparent ? rgb888_3Byte : depth;
+    size_t bytes = (sdepth & color_depth_t::bit_mask) >> 3;
+
+    LGFX_Sprite sprites[2];
+    TextStyle style = gfx->getTextStyle();
+    style.datum = (textdatum_t)key.datum;
+    int32_t text_width = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+      auto& sp = sprites[i];
+      sp.setPsram(false);
+      sp.setColorDepth(sdepth);
+      if (!sp.createSprite(sw, sh)) { return nullptr; }
+      memset(sp.getBuffer(), i ? 0xFF : 0x00, sp.bufferLength());
+      sp.setFont(key.font);
+      sp.setTextStyle(style);
+      sp.setBaseColor(key.base_rgb888);
+      text_width = sp.drawString(string, ax, ay);
+    }
+    auto pa = (const uint8_t*)sprites[0].getBuffer();
+    auto pb = (const uint8_t*)sprites[1].getBuffer();
+    uint32_t white = (1u << (bytes * 8)) - 1;
+
+    int32_t l = sw, r = -1, t = sh, b = -1;
+    uint32_t touched = 0;
+    bool blended = false;
+    for (int32_t py = 0; py < sh; ++py)
+    {
+      for (int32_t px = 0; px < sw; ++px)
+      {
+        size_t idx = (py * sw + px) * bytes;
+        uint32_t va = load_raw(&pa[idx], bytes);
+        uint32_t vb = load_raw(&pb[idx], bytes);
+        if (va == 0 && vb == white) { continue; }
+        if (va != vb) { blended = true; }
+        ++touched;
+        if (l > px) { l = px; }
+        if (r < px) { r = px; }
+        if (t > py) { t = py; }
+        if (b < py) { b = py; }
+      }
+    }
+
+    if (blended && (!transparent || !gfx->isReadable())) { return nullptr; }
+    // a glyph reaching the sprite edge may have been clipped.
+    if (touched && (l == 0 || t == 0 || r == sw - 1 || b == sh - 1)) { return nullptr; }
+
+    int32_t w = touched ? r - l + 1 : 0;
+    int32_t h = touched ? b - t + 1 : 0;
+
+    image_type_t type = blended ? image_alpha
+                      : ((uint32_t)(w * h) == touched) ? image_opaque
+                      : image_keyed;
+    size_t dst_bytes = (type == image_alpha) ? sizeof(bgra8888_t) : ((depth & color_depth_t::bit_mask) >> 3);
+
+    uint32_t transp = 0;
+    if (type == image_keyed)
+    { // 描画された画素に含まれない色を透過色として選ぶ
+      uint32_t dst_mask = (1u << (dst_bytes * 8)) - 1;
+      auto conv = gfx->getColorConverter();
+      int retry = 16;
+      bool found = false;
+      do
+      {
+        transp = (transp * 2654435761u + 0x5A5A5Au) & dst_mask;
+        found = true;
+        for (int32_t py = t; found && py <= b; ++py)
+        {
+          for (int32_t px = l; px <= r; ++px)
+          {
+            size_t idx = (py * sw + px) * bytes;
+            uint32_t va = load_raw(&pa[idx], bytes);
+            if (va == 0 && load_raw(&pb[idx], bytes) == white) { continue; }
+            if (transparent)
+            {
+              va = conv->convert(lgfx::color888(pa[idx], pa[idx + 1], pa[idx + 2]));
+            }
+            if (va == transp) { found = false; break; }
+          }
+        }
+      } while (!found && --retry);
+      if (!found) { return nullptr; }
+    }
+
+    size_t image_offset = (sizeof(entry_t) + length + 1 + 3) & ~3u;
+    size_t size = image_offset + w * h * dst_bytes;
+    auto entry = (entry_t*)(_psram ? heap_alloc_psram(size) : heap_alloc(size));
+    if (entry == nullptr) { entry = (entry_t*)heap_alloc(size); }
+    if (entry == nullptr) { return nullptr; }
+
+    memset(entry, 0, sizeof(entry_t));
+    entry->key = key;
+    entry->hash = hash;
+    entry->size = size;
+    entry->transp = transp;
+    entry->dx = l - ax;
+    entry->dy = t - ay;
+    entry->w = w;
+    entry->h = h;
+    entry->text_width = text_width;
+    entry->type = type;
+    entry->string = (char*)&entry[1];
+    memcpy(entry->string, string, length + 1);
+    entry->image = (uint8_t*)entry + image_offset;
+
+    auto conv = gfx->getColorConverter();
+    auto dst = entry->image;
+    for (int32_t py = t; py <= b; ++py)
+    {
+      for (int32_t px = l; px <= r; ++px)
+      {
+        size_t idx = (py * sw + px) * bytes;
+        uint32_t va = load_raw(&pa[idx], bytes);
+        uint32_t vb = load_raw(&pb[idx], bytes);
+        bool untouched = (va == 0 && vb == white);
+        if (type == image_alpha)
+        {
+          auto d = (bgra8888_t*)dst;
+          if (untouched)
+          {
+            d->raw = 0;
+          }
+          else
+          { // 黒背景と白背景の差から不透明度を、黒背景の値から色を求める
+            int32_t diff = (pb[idx] - pa[idx]) + (pb[idx + 1] - pa[idx + 1]) + (pb[idx + 2] - pa[idx + 2]);
+            int32_t a = 255 - (diff + 1) / 3;
+            if (a <= 0) { d->raw = 0; }
+            else
+            {
+              d->a = a;
+              d->r = std::min<int32_t>(255, (pa[idx    ] * 255 + (a >> 1)) / a);
+              d->g = std::min<int32_t>(255, (pa[idx + 1] * 255 + (a >> 1)) / a);
+              d->b = std::min<int32_t>(255, (pa[idx + 2] * 255 + (a >> 1)) / a);
+            }
+          }
+        }
+        else
+        {
+          if (untouched) { va = transp; }
+          else if (transparent) { va = conv->convert(lgfx::color888(pa[idx], pa[idx + 1], pa[idx + 2])); }
+          store_raw(dst, va, dst_bytes);
+        }
+        dst += dst_bytes;
+      }
+    }
+    return entry;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
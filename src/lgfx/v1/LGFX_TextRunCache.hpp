@@ -0,0 +1,130 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "misc/enum.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  class LGFXBase;
+  struct IFont;
+
+// 描画済みの文字列を画像として保持し、同じ条件の drawString を一回の pushImage で済ませるキャッシュ。
+// 文字列・フォント・サイズ・色・datum・padding が一致した場合のみ使用される。
+/// Keeps rendered text runs as images, so that a drawString with the same
+/// string, font, size, colors, datum and padding becomes a single pushImage.
+/// Usage: lcd.setTextRunCache(&cache);
+
+  class LGFX_TextRunCache
+  {
+  public:
+    struct stats_t
+    {
+      uint32_t hits = 0;       // drawn from the cache
+      uint32_t misses = 0;     // rendered and stored
+      uint32_t bypasses = 0;   // not cacheable, drawn normally
+      uint32_t evictions = 0;  // removed to stay within the budget
+      uint32_t entries = 0;
+      uint32_t used_bytes = 0;
+    };
+
+    LGFX_TextRunCache(uint32_t budget_bytes = 16384) : _budget(budget_bytes) {}
+    ~LGFX_TextRunCache(void) { clear(); }
+
+    LGFX_TextRunCache(const LGFX_TextRunCache&) = delete;
+    LGFX_TextRunCache& operator=(const LGFX_TextRunCache&) = delete;
+
+    /// Memory budget for the stored images. Older runs are evicted when exceeded.
+    void setBudget(uint32_t bytes);
+    uint32_t getBudget(void) const { return _budget; }
+
+    /// Use PSRAM for the stored images when available. (default: false)
+    void setPsram(bool enabled) { _psram = enabled; }
+
+    /// Remove all stored runs. (statistics are kept)
+    void clear(void);
+
+    const stats_t& getStats(void) const { return _stats; }
+    void resetStats(void) { uint32_t e = _stats.entries, u = _stats.used_bytes; _stats = stats_t(); _stats.entries = e; _stats.used_bytes = u; }
+
+    /// Called from LGFXBase::drawString. Returns false when the run can not be cached,
+    /// in which case the caller draws it normally.
+    bool drawString(LGFXBase* gfx, const char* string, int32_t x, int32_t y, textdatum_t datum, const IFont* font, size_t* width);
+
+  protected:
+    struct key_t
+    {
+      const IFont* font;
+      uint32_t fore_rgb888;
+      uint32_t back_rgb888;
+      uint32_t base_rgb888;
+      float size_x;
+      float size_y;
+      int32_t padding_x;
+      uint8_t datum;
+      uint8_t depth;
+      bool utf8;
+      bool cp437;
+    };
+
+    enum image_type_t : uint8_t
+    {
+      image_opaque,  // raw pixels of the target color depth
+      image_keyed,   // raw pixels, untouched pixels are the transparent key
+      image_alpha,   // bgra8888_t, blended onto the target
+    };
+
+    struct entry_t
+    {
+      entry_t* prev;  // toward the most recently used
+      entry_t* next;  // toward the least recently used
+      key_t key;
+      uint32_t hash;
+      uint32_t size;        // bytes of this allocation
+      uint32_t transp;      // transparent raw color for image_keyed
+      int32_t dx, dy;       // image position relative to the drawString point
+      int32_t w, h;
+      int32_t text_width;   // drawString result
+      image_type_t type;
+      char* string;
+      uint8_t* image;
+    };
+
+    entry_t* _head = nullptr;
+    entry_t* _tail = nullptr;
+    uint32_t _budget;
+    bool _psram = false;
+    stats_t _stats;
+
+    entry_t* render(LGFXBase* gfx, const key_t& key, uint32_t hash, const char* string, size_t length);
+    void draw(LGFXBase* gfx, const entry_t* entry, int32_t x, int32_t y);
+    void unlink(entry_t* entry);
+    void pushFront(entry_t* entry);
+    void evict(uint32_t limit);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
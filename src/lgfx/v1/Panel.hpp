@@ -23,6 +23,7 @@ Contributors:
 #include "misc/enum.hpp"
 #include "misc/colortype.hpp"
 #include "misc/pixelcopy.hpp"
+#include "misc/range.hpp"
 
 namespace lgfx
 {
@@ -128,6 +129,15 @@ namespace lgfx
     virtual void setWindow(uint_fast16_t xs, uint_fast16_t ys, uint_fast16_t xe, uint_fast16_t ye) = 0;
     virtual void drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) = 0;
     virtual void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) = 0;
+    /// Fills rects of the same color at once. They must be clipped already and may be written in any order.
+    virtual void writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t rawcolor)
+    {
+      for (size_t i = 0; i < count; ++i)
+      {
+        auto& r = rects[i];
+        writeFillRectPreclipped(r.x, r.y, r.w, r.h, rawcolor);
+      }
+    }
     virtual void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) = 0;
     virtual void writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param) = 0;
     virtual void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) = 0;
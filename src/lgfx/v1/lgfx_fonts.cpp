@@ -1,6 +1,7 @@
 #include "lgfx_fonts.hpp"
 
 #include "platforms/common.hpp"
+#include "misc/Allocator.hpp"
 #include "misc/pixelcopy.hpp"
 #include "LGFXBase.hpp"
 
@@ -737,11 +738,16 @@ label_nextbyte: /// 次のデータを取得する;
   bool VLWfont::unloadFont(void)
   {
     _fontLoaded = false;
-    if (gUnicode)  { heap_free(gUnicode);  gUnicode  = nullptr; }
-    if (gWidth)    { heap_free(gWidth);    gWidth    = nullptr; }
-    if (gxAdvance) { heap_free(gxAdvance); gxAdvance = nullptr; }
-    if (gdX)       { heap_free(gdX);       gdX       = nullptr; }
-    if (gBitmap)   { heap_free(gBitmap);   gBitmap   = nullptr; }
+    if (gUnicode)  { buffer_free(gUnicode);  gUnicode  = nullptr; }
+    if (gWidth)    { buffer_free(gWidth);    gWidth    = nullptr; }
+    if (gxAdvance) { buffer_free(gxAdvance); gxAdvance = nullptr; }
+    if (gdX)       { buffer_free(gdX);       gdX       = nullptr; }
+    if (gBitmap)   { buffer_free(gBitmap);   gBitmap   = nullptr; }
+    if (gHeight)   { buffer_free(gHeight);   gHeight   = nullptr; }
+    if (gdY)       { buffer_free(gdY);       gdY       = nullptr; }
+    if (_preload)  { buffer_free(_preload);  _preload  = nullptr; }
+    _preload_begin = _preload_end = 0;
+    cacheRelease();
     if (_fontData) {
       _fontData->preRead();
       _fontData->close();
@@ -762,7 +768,7 @@ label_nextbyte: /// 次のデータを取得する;
   bool VLWfont::updateFontMetric(FontMetrics *metrics, uint16_t uniCode) const {
     uint16_t gNum = 0;
     if (getUnicodeIndex(uniCode, &gNum)) {
-      if (gWidth && gxAdvance && gdX[gNum]) {
+      if (gWidth && gxAdvance && gdX) {
         metrics->width     = gWidth[gNum];
         metrics->x_advance = gxAdvance[gNum];
         metrics->x_offset  = gdX[gNum];
@@ -816,23 +822,29 @@ label_nextbyte: /// 次のデータを取得する;
 
     uint32_t bitmapPtr = 24 + (uint32_t)gCount * 28;
 
-    gBitmap   = (uint32_t*)heap_alloc_psram( gCount * 4); // seek pointer to glyph bitmap in the file
-    gUnicode  = (uint16_t*)heap_alloc_psram( gCount * 2); // Unicode 16 bit Basic Multilingual Plane (0-FFFF)
-    gWidth    =  (uint8_t*)heap_alloc_psram( gCount );    // Width of glyph
-    gxAdvance =  (uint8_t*)heap_alloc_psram( gCount );    // xAdvance - to move x cursor
-    gdX       =   (int8_t*)heap_alloc_psram( gCount );    // offset for bitmap left edge relative to cursor X
-
-    if (nullptr == gBitmap  ) gBitmap   = (uint32_t*)heap_alloc( gCount * 4); // seek pointer to glyph bitmap in the file
-    if (nullptr == gUnicode ) gUnicode  = (uint16_t*)heap_alloc( gCount * 2); // Unicode 16 bit Basic Multilingual Plane (0-FFFF)
-    if (nullptr == gWidth   ) gWidth    =  (uint8_t*)heap_alloc( gCount );    // Width of glyph
-    if (nullptr == gxAdvance) gxAdvance =  (uint8_t*)heap_alloc( gCount );    // xAdvance - to move x cursor
-    if (nullptr == gdX      ) gdX       =   (int8_t*)heap_alloc( gCount );    // offset for bitmap left edge relative to cursor X
+    gBitmap   = (uint32_t*)buffer_alloc(gCount * 4, AllocationSource::Psram); // seek pointer to glyph bitmap in the file
+    gUnicode  = (uint16_t*)buffer_alloc(gCount * 2, AllocationSource::Psram); // Unicode 16 bit Basic Multilingual Plane (0-FFFF)
+    gWidth    =  (uint8_t*)buffer_alloc(gCount, AllocationSource::Psram);    // Width of glyph
+    gxAdvance =  (uint8_t*)buffer_alloc(gCount, AllocationSource::Psram);    // xAdvance - to move x cursor
+    gdX       =   (int8_t*)buffer_alloc(gCount, AllocationSource::Psram);    // offset for bitmap left edge relative to cursor X
+    gHeight   = (uint16_t*)buffer_alloc(gCount * 2, AllocationSource::Psram); // Height of glyph
+    gdY       =  (int16_t*)buffer_alloc(gCount * 2, AllocationSource::Psram); // offset for bitmap top edge relative to baseline
+
+    if (nullptr == gBitmap  ) gBitmap   = (uint32_t*)buffer_alloc(gCount * 4, AllocationSource::Normal); // seek pointer to glyph bitmap in the file
+    if (nullptr == gUnicode ) gUnicode  = (uint16_t*)buffer_alloc(gCount * 2, AllocationSource::Normal); // Unicode 16 bit Basic Multilingual Plane (0-FFFF)
+    if (nullptr == gWidth   ) gWidth    =  (uint8_t*)buffer_alloc(gCount, AllocationSource::Normal);    // Width of glyph
+    if (nullptr == gxAdvance) gxAdvance =  (uint8_t*)buffer_alloc(gCount, AllocationSource::Normal);    // xAdvance - to move x cursor
+    if (nullptr == gdX      ) gdX       =   (int8_t*)buffer_alloc(gCount, AllocationSource::Normal);    // offset for bitmap left edge relative to cursor X
+    if (nullptr == gHeight  ) gHeight   = (uint16_t*)buffer_alloc(gCount * 2, AllocationSource::Normal); // Height of glyph
+    if (nullptr == gdY      ) gdY       =  (int16_t*)buffer_alloc(gCount * 2, AllocationSource::Normal); // offset for bitmap top edge relative to baseline
 
     if (!gUnicode
       || !gBitmap
       || !gWidth
       || !gxAdvance
-      || !gdX) {
+      || !gdX
+      || !gHeight
+      || !gdY) {
 //ESP_LOGE("LGFX", "can not alloc font table");
       return false;
     }
@@ -852,8 +864,10 @@ label_nextbyte: /// 次のデータを取得する;
       if (gdX)        gdX[gNum]       =  (int8_t)getSwap32(buffer[5]); // x delta from cursor
 
       uint16_t height = getSwap32(buffer[1]); // Height of glyph
+      int16_t dY =  (int16_t)getSwap32(buffer[4]); // y delta from baseline
+      gHeight[gNum] = height;
+      gdY[gNum]     = dY;
       if ((unicode > 0xFF) || ((unicode > 0x20) && (unicode < 0xA0) && (unicode != 0x7F))) {
-        int16_t dY =  (int16_t)getSwap32(buffer[4]); // y delta from baseline
 //Serial.printf("LGFX:unicode:%x  dY:%d\r\n", unicode, dY);
         if (maxAscent < dY && unicode != 0x3000) {
           maxAscent = dY;
@@ -871,49 +885,223 @@ label_nextbyte: /// 次のデータを取得する;
     yAdvance = maxAscent + maxDescent;
 
 //Serial.printf("LGFX:maxDescent:%d\r\n", maxDescent);
+
+    preloadGlyphs();
+    setCacheConfig(_cache_cfg);
     return true;
   }
 
+  void VLWfont::setCacheConfig(const cache_config_t& cfg)
+  {
+    _cache_cfg = cfg;
+    if (!_fontLoaded) return;
+
+    if (cfg.cache_bytes == 0)
+    {
+      cacheRelease();
+      return;
+    }
+    cacheEvict(cfg.cache_bytes);
+    if (_cache_index == nullptr)
+    {
+      _cache_index = (uint16_t*)buffer_alloc(gCount * sizeof(uint16_t), AllocationSource::Normal);
+      if (_cache_index) { memset(_cache_index, 0xFF, gCount * sizeof(uint16_t)); }
+    }
+  }
+
+  void VLWfont::preloadGlyphs(void)
+  {
+    if (_cache_cfg.preload_first > _cache_cfg.preload_last) return;
+
+    // グリフはUnicode順に並んでおり、画像もファイル上で連続しているため一度に読み込める
+    uint16_t begin = std::distance(gUnicode, std::lower_bound(gUnicode, &gUnicode[gCount], _cache_cfg.preload_first));
+    uint16_t end   = std::distance(gUnicode, std::upper_bound(gUnicode, &gUnicode[gCount], _cache_cfg.preload_last));
+    if (begin >= end) return;
+
+    uint32_t top = gBitmap[begin];
+    size_t len = gBitmap[end - 1] + gWidth[end - 1] * gHeight[end - 1] - top;
+    if (len == 0) return;
+
+    uint8_t* data = nullptr;
+    if (_cache_cfg.use_psram) { data = (uint8_t*)buffer_alloc(len, AllocationSource::Psram); }
+    if (data == nullptr) { data = (uint8_t*)buffer_alloc(len, AllocationSource::Normal); }
+    if (data == nullptr) return;
+
+    _fontData->seek(top);
+    if (_fontData->read(data, len) != (int)len)
+    {
+      buffer_free(data);
+      return;
+    }
+    _preload = data;
+    _preload_begin = begin;
+    _preload_end = end;
+  }
+
+  void VLWfont::cacheRelease(void) const
+  {
+    if (_cache_entries)
+    {
+      for (size_t i = 0; i < _cache_count; ++i) { buffer_free(_cache_entries[i].bitmap); }
+      buffer_free(_cache_entries);
+      _cache_entries = nullptr;
+    }
+    if (_cache_index) { buffer_free(_cache_index); _cache_index = nullptr; }
+    _cache_capacity = 0;
+    _cache_count = 0;
+    _cache_head = _cache_tail = cache_none;
+    _cache_used = 0;
+  }
+
+  void VLWfont::cacheUnlink(uint16_t idx) const
+  {
+    auto& e = _cache_entries[idx];
+    if (e.prev == cache_none) { _cache_head = e.next; } else { _cache_entries[e.prev].next = e.next; }
+    if (e.next == cache_none) { _cache_tail = e.prev; } else { _cache_entries[e.next].prev = e.prev; }
+  }
+
+  void VLWfont::cachePushFront(uint16_t idx) const
+  {
+    auto& e = _cache_entries[idx];
+    e.prev = cache_none;
+    e.next = _cache_head;
+    if (_cache_head == cache_none) { _cache_tail = idx; } else { _cache_entries[_cache_head].prev = idx; }
+    _cache_head = idx;
+  }
+
+  void VLWfont::cacheEvict(uint32_t limit) const
+  {
+    while (_cache_used > limit && _cache_tail != cache_none)
+    {
+      uint16_t idx = _cache_tail;
+      auto& e = _cache_entries[idx];
+      cacheUnlink(idx);
+      _cache_used -= gWidth[e.glyph] * gHeight[e.glyph];
+      _cache_index[e.glyph] = cache_none;
+      buffer_free(e.bitmap);
+
+      // 末尾のエントリを空いた位置へ移し、エントリ配列を詰めておく
+      uint16_t last = --_cache_count;
+      if (idx != last)
+      {
+        e = _cache_entries[last];
+        if (e.prev == cache_none) { _cache_head = idx; } else { _cache_entries[e.prev].next = idx; }
+        if (e.next == cache_none) { _cache_tail = idx; } else { _cache_entries[e.next].prev = idx; }
+        _cache_index[e.glyph] = idx;
+      }
+    }
+  }
+
+  const uint8_t* VLWfont::getGlyphBitmap(uint16_t gNum) const
+  {
+    if ((uint32_t)(gNum - _preload_begin) < (uint32_t)(_preload_end - _preload_begin))
+    {
+      ++_cache_hits;
+      return &_preload[gBitmap[gNum] - gBitmap[_preload_begin]];
+    }
+    if (_cache_index)
+    {
+      uint16_t idx = _cache_index[gNum];
+      if (idx != cache_none)
+      {
+        ++_cache_hits;
+        if (idx != _cache_head)
+        {
+          cacheUnlink(idx);
+          cachePushFront(idx);
+        }
+        return _cache_entries[idx].bitmap;
+      }
+    }
+    ++_cache_misses;
+
+    uint32_t len = gWidth[gNum] * gHeight[gNum];
+    if (_cache_index == nullptr || len == 0 || len > _cache_cfg.cache_bytes) return nullptr;
+
+    cacheEvict(_cache_cfg.cache_bytes - len);
+    if (_cache_count == _cache_capacity)
+    {
+      if (_cache_capacity >= cache_none - 16) return nullptr;
+      uint16_t newcap = _cache_capacity ? std::min<uint32_t>(cache_none - 1, _cache_capacity << 1) : 16;
+      auto entries = (cache_entry_t*)buffer_alloc(newcap * sizeof(cache_entry_t), AllocationSource::Normal);
+      if (entries == nullptr) return nullptr;
+      if (_cache_entries)
+      {
+        memcpy(entries, _cache_entries, _cache_count * sizeof(cache_entry_t));
+        buffer_free(_cache_entries);
+      }
+      _cache_entries = entries;
+      _cache_capacity = newcap;
+    }
+
+    uint8_t* bitmap = nullptr;
+    if (_cache_cfg.use_psram) { bitmap = (uint8_t*)buffer_alloc(len, AllocationSource::Psram); }
+    if (bitmap == nullptr) { bitmap = (uint8_t*)buffer_alloc(len, AllocationSource::Normal); }
+    if (bitmap == nullptr) return nullptr;
+
+    auto file = _fontData;
+    file->preRead();
+    file->seek(gBitmap[gNum]);
+    file->read(bitmap, len);
+    file->postRead();
+
+    uint16_t idx = _cache_count++;
+    _cache_entries[idx].bitmap = bitmap;
+    _cache_entries[idx].glyph = gNum;
+    cachePushFront(idx);
+    _cache_index[gNum] = idx;
+    _cache_used += len;
+    return bitmap;
+  }
+
 //----------------------------------------------------------------------------
 
   size_t VLWfont::drawChar(LGFXBase* gfx, int32_t x, int32_t y, uint16_t code, const TextStyle* style, FontMetrics* metrics, int32_t& filled_x) const
   {
-    auto file = this->_fontData;
-
-    uint32_t buffer[6] = {0};
     uint16_t gNum = 0;
 
     int32_t sy = 65536 * style->size_y;
     y += (metrics->y_offset * sy) >> 16;
 
+    int32_t h = 0;
+    int32_t w = 0;
+    int32_t advance = this->spaceWidth;
+    int32_t dX = 0;
+    int32_t dY = 0;
+    const uint8_t* pixel = nullptr;
+
     if (code == 0x20) {
       gNum = 0xFFFF;
-      buffer[2] = getSwap32(this->spaceWidth);
     } else if (!this->getUnicodeIndex(code, &gNum)) {
       return drawCharDummy(gfx, x, y, this->spaceWidth, metrics->height, style, filled_x);
     } else {
-      file->preRead();
-      file->seek(28 + gNum * 28);
-      file->read((uint8_t*)buffer, 24);
-      file->seek(this->gBitmap[gNum]);
+      h       = this->gHeight[gNum];   // Height of glyph
+      w       = this->gWidth[gNum];    // Width of glyph
+      advance = this->gxAdvance[gNum]; // xAdvance - to move x cursor
+      dX      = this->gdX[gNum];       // x delta from cursor
+      dY      = this->gdY[gNum];       // y delta from baseline
+      if (w && h)
+      {
+        pixel = getGlyphBitmap(gNum);
+        if (pixel == nullptr)
+        { // not cached. read from file.
+          auto buf = (uint8_t*)alloca(w * h);
+          auto file = this->_fontData;
+          file->preRead();
+          file->seek(this->gBitmap[gNum]);
+          file->read(buf, w * h);
+          file->postRead();
+          pixel = buf;
+        }
+      }
     }
 
-
-    int32_t h        = getSwap32(buffer[0]); // Height of glyph
-    int32_t w        = getSwap32(buffer[1]); // Width of glyph
     int32_t sx       = 65536 * style->size_x;
-    int32_t xAdvance = (getSwap32(buffer[2]) * sx) >> 16; // xAdvance - to move x cursor
-    int32_t xoffset  = ((int32_t)((int8_t)getSwap32(buffer[4])) * sx) >> 16; // x delta from cursor
-    int32_t dY       = (int16_t)getSwap32(buffer[3]); // y delta from baseline
+    int32_t xAdvance = (advance * sx) >> 16; // xAdvance - to move x cursor
+    int32_t xoffset  = (dX * sx) >> 16; // x delta from cursor
     int32_t yoffset  = (this->maxAscent - dY);
 //      int32_t yoffset = (gfx->_font_metrics.y_offset) - dY;
 
-    auto pixel = (uint8_t*)alloca(w * h);
-    if (gNum != 0xFFFF) {
-      file->read(pixel, w * h);
-      file->postRead();
-    }
-
     gfx->startWrite();
 
     uint32_t colortbl[2] = {gfx->getColorConverter()->convert(style->back_rgb888), gfx->getColorConverter()->convert(style->fore_rgb888)};
@@ -240,6 +240,32 @@ namespace lgfx
     uint8_t*  gxAdvance = nullptr;  //setWidth
     int8_t*   gdX       = nullptr;  //leftExtent
     uint32_t* gBitmap   = nullptr;  //file pointer to greyscale bitmap
+    uint16_t* gHeight   = nullptr;  //gheight
+    int16_t*  gdY       = nullptr;  //topExtent
+
+    /// Glyph bitmap cache settings. Applied by loadFont.
+    struct cache_config_t
+    {
+      /// Memory budget for the LRU cache of glyph bitmaps. (0 = disabled)
+      uint32_t cache_bytes = 0;
+
+      /// Place cached / preloaded bitmaps in PSRAM when available.
+      bool use_psram = true;
+
+      /// Unicode range (inclusive) read into RAM at once by loadFont.
+      /// Preloaded glyphs never touch the file and are not counted in cache_bytes.
+      /// (preload_first > preload_last = disabled)
+      uint16_t preload_first = 1;
+      uint16_t preload_last  = 0;
+    };
+
+    void setCacheConfig(const cache_config_t& cfg);
+    const cache_config_t& getCacheConfig(void) const { return _cache_cfg; }
+
+    /// Number of glyph bitmaps served from RAM / read from the file.
+    uint32_t getCacheHits(void) const { return _cache_hits; }
+    uint32_t getCacheMisses(void) const { return _cache_misses; }
+    void resetCacheStats(void) { _cache_hits = 0; _cache_misses = 0; }
 
     font_type_t getType(void) const override { return ft_vlw; }
 
@@ -256,6 +282,41 @@ namespace lgfx
     bool updateFontMetric(FontMetrics *metrics, uint16_t uniCode) const override;
 
     bool getUnicodeIndex(uint16_t unicode, uint16_t *index) const;
+
+  protected:
+    struct cache_entry_t
+    {
+      uint8_t* bitmap;
+      uint16_t glyph;
+      uint16_t prev;  // LRU list, toward the most recently used
+      uint16_t next;  // LRU list, toward the least recently used
+    };
+    static constexpr uint16_t cache_none = 0xFFFF;
+
+    cache_config_t _cache_cfg;
+
+    // 先読みした範囲のグリフ画像。グリフ番号 [_preload_begin, _preload_end)
+    uint8_t* _preload = nullptr;
+    uint16_t _preload_begin = 0;
+    uint16_t _preload_end = 0;
+
+    // グリフ番号 -> キャッシュのエントリ番号 (cache_none = 未キャッシュ)
+    mutable uint16_t* _cache_index = nullptr;
+    mutable cache_entry_t* _cache_entries = nullptr;
+    mutable uint16_t _cache_capacity = 0;
+    mutable uint16_t _cache_count = 0;
+    mutable uint16_t _cache_head = cache_none;  // most recently used
+    mutable uint16_t _cache_tail = cache_none;  // least recently used
+    mutable uint32_t _cache_used = 0;
+    mutable uint32_t _cache_hits = 0;
+    mutable uint32_t _cache_misses = 0;
+
+    const uint8_t* getGlyphBitmap(uint16_t gNum) const;
+    void preloadGlyphs(void);
+    void cacheRelease(void) const;
+    void cacheEvict(uint32_t limit) const;
+    void cacheUnlink(uint16_t idx) const;
+    void cachePushFront(uint16_t idx) const;
   };
 
 //----------------------------------------------------------------------------
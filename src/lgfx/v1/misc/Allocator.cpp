@@ -0,0 +1,220 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#include "Allocator.hpp"
+
+#include "../../internal/algorithm.h"
+#include "../platforms/common.hpp"
+
+#include <string.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  static IAllocator* _allocator = nullptr;
+
+  static void* heap_alloc_source(size_t length, AllocationSource source)
+  {
+    switch (source)
+    {
+    case AllocationSource::Dma:   return heap_alloc_dma(length);
+    case AllocationSource::Psram: return heap_alloc_psram(length);
+    default:                      return heap_alloc(length);
+    }
+  }
+
+  void setAllocator(IAllocator* allocator)
+  {
+    _allocator = allocator;
+  }
+
+  IAllocator* getAllocator(void)
+  {
+    return _allocator;
+  }
+
+  void* buffer_alloc(size_t length, AllocationSource source)
+  {
+    if (_allocator) { return _allocator->allocate(length, source); }
+    return heap_alloc_source(length, source);
+  }
+
+  void buffer_free(void* buf)
+  {
+    if (buf == nullptr) { return; }
+    if (_allocator) { _allocator->deallocate(buf); }
+    else { heap_free(buf); }
+  }
+
+//----------------------------------------------------------------------------
+
+  // ブロックの先頭にはヘッダを置き、解放時にサイズクラスを判別する
+  struct pool_header_t
+  {
+    uint32_t magic;
+    uint32_t index;
+  };
+  static constexpr uint32_t POOL_MAGIC = 0x4C474658; // "LGFX"
+
+  PoolAllocator::PoolAllocator(size_t arena_size, AllocationSource arena_source)
+  : PoolAllocator(nullptr, 0, arena_source)
+  {
+    _arena_alloc = heap_alloc_source(arena_size, arena_source);
+    init_arena(_arena_alloc, arena_size);
+  }
+
+  PoolAllocator::PoolAllocator(void* arena, size_t arena_size, AllocationSource arena_source)
+  : _arena_source(arena_source)
+  {
+    memset(_free_list, 0, sizeof(_free_list));
+    memset(&_stats, 0, sizeof(_stats));
+    init_arena(arena, arena_size);
+  }
+
+  void PoolAllocator::init_arena(void* arena, size_t arena_size)
+  {
+    if (arena == nullptr) { return; }
+
+    // ブロック境界を8Byte単位に揃える
+    size_t skip = (8 - ((uintptr_t)arena & 7)) & 7;
+    if (arena_size <= skip) { return; }
+    _arena = static_cast<uint8_t*>(arena) + skip;
+    _arena_size = arena_size - skip;
+    _stats.arena_size = _arena_size;
+  }
+
+  PoolAllocator::~PoolAllocator(void)
+  {
+    if (_arena_alloc) { heap_free(_arena_alloc); }
+  }
+
+  uint_fast8_t PoolAllocator::class_index(size_t length)
+  {
+    if (length <= MIN_CLASS) { return 0; }
+    // length は (2^e, 2^(e+1)] にあり、その区間を4つの刻みに分ける
+    size_t v = length - 1;
+    uint_fast8_t e = 0;
+    while (v >>= 1) { ++e; }
+    size_t step = (size_t)1 << (e - 2);
+    size_t k = ((length - ((size_t)1 << e)) + step - 1) >> (e - 2);
+    return (e - 5) * 4 + k;
+  }
+
+  size_t PoolAllocator::classSize(size_t length)
+  {
+    auto idx = class_index(length);
+    return (idx < CLASS_COUNT) ? class_size(idx) : 0;
+  }
+
+  bool PoolAllocator::accepts(AllocationSource source) const
+  {
+    if (source == _arena_source) { return true; }
+    return _arena_source == AllocationSource::Dma && source == AllocationSource::Normal;
+  }
+
+  uint8_t* PoolAllocator::pop_free(uint_fast8_t index)
+  {
+    auto block = static_cast<uint8_t*>(_free_list[index]);
+    if (block)
+    { // 空きブロックの本体に次の空きブロックへのポインタを置いている
+      memcpy(&_free_list[index], block + HEADER_SIZE, sizeof(void*));
+    }
+    return block;
+  }
+
+  void* PoolAllocator::allocate(size_t length, AllocationSource source)
+  {
+    if (length == 0) { return nullptr; }
+    uint_fast8_t idx = class_index(length);
+    if (_arena && idx < CLASS_COUNT && accepts(source))
+    {
+      uint_fast8_t use = idx;
+      uint8_t* block = pop_free(idx);
+      if (block == nullptr)
+      {
+        size_t need = HEADER_SIZE + class_size(idx);
+        if (_arena_pos + need <= _arena_size)
+        {
+          block = &_arena[_arena_pos];
+          _arena_pos += need;
+          _stats.arena_used = _arena_pos;
+        }
+        else
+        { // アリーナの残りが足りなければ、少し大きなクラスの空きブロックを流用する
+          uint_fast8_t end = std::min<uint_fast8_t>(CLASS_COUNT, idx + 1 + CLASS_SEARCH);
+          for (use = idx + 1; use < end && block == nullptr; ++use)
+          {
+            block = pop_free(use);
+          }
+          --use;
+        }
+      }
+
+      if (block)
+      {
+        auto h = reinterpret_cast<pool_header_t*>(block);
+        h->magic = POOL_MAGIC;
+        h->index = use;
+        ++_stats.alloc_count;
+        _stats.in_use += class_size(use);
+        if (_stats.high_water < _stats.in_use) { _stats.high_water = _stats.in_use; }
+        return block + HEADER_SIZE;
+      }
+    }
+
+    void* buf = heap_alloc_source(length, source);
+    if (buf)
+    {
+      ++_stats.alloc_count;
+      ++_stats.fallback_count;
+    }
+    else if (source == AllocationSource::Psram)
+    {
+      ++_stats.psram_miss_count;
+    }
+    else
+    {
+      ++_stats.fail_count;
+    }
+    return buf;
+  }
+
+  void PoolAllocator::deallocate(void* buf)
+  {
+    if (buf == nullptr) { return; }
+    ++_stats.free_count;
+    if (!owns(buf))
+    {
+      heap_free(buf);
+      return;
+    }
+    auto block = static_cast<uint8_t*>(buf) - HEADER_SIZE;
+    auto h = reinterpret_cast<pool_header_t*>(block);
+    if (h->magic != POOL_MAGIC || h->index >= CLASS_COUNT) { return; }
+    uint_fast8_t idx = h->index;
+    h->magic = 0;
+    _stats.in_use -= class_size(idx);
+    memcpy(buf, &_free_list[idx], sizeof(void*));
+    _free_list[idx] = block;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -0,0 +1,133 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "SpriteBuffer.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  // スプライトやデコーダの作業用バッファの確保先を差し替えるためのインタフェース
+  /// Allocator used for SpriteBuffer and the transient buffers of the image decoders and VLW fonts.
+  struct IAllocator
+  {
+    virtual ~IAllocator(void) = default;
+
+    /// Returns length bytes suitable for source (Normal / Dma / Psram), or nullptr.
+    virtual void* allocate(size_t length, AllocationSource source) = 0;
+
+    /// Frees a buffer returned by allocate().
+    virtual void deallocate(void* buf) = 0;
+  };
+
+  // nullptrを設定すると既定の heap_alloc_* / heap_free に戻る。
+  // 確保済みのバッファは確保したアロケータで解放されるため、差し替えはバッファを確保する前に行うこと
+  /// Installs a global allocator (nullptr restores the platform heap_alloc_* functions).
+  /// Install it before any buffer is allocated: buffers are freed through the allocator that is current at that time.
+  void setAllocator(IAllocator* allocator);
+  IAllocator* getAllocator(void);
+
+  /// Allocates through the current allocator.
+  void* buffer_alloc(size_t length, AllocationSource source);
+  /// Frees through the current allocator. nullptr is ignored.
+  void buffer_free(void* buf);
+
+//----------------------------------------------------------------------------
+
+  struct allocator_stats_t
+  {
+    size_t arena_size;     // アリーナ全体のByte数
+    size_t arena_used;     // アリーナから切り出し済みのByte数 (ブロックヘッダ含む)
+    size_t in_use;         // 使用中ブロックのByte数 (サイズクラス単位)
+    size_t high_water;     // in_useの最大値
+    uint32_t alloc_count;
+    uint32_t free_count;
+    uint32_t fallback_count; // アリーナに入らずヒープから確保した回数
+    uint32_t psram_miss_count; // PSRAMから確保できなかった回数 (呼出し側は他の確保先で再試行する)
+    uint32_t fail_count;     // 確保できなかった回数 (psram_miss_count を除く)
+  };
+
+  // 固定長のアリーナをサイズクラスごとのフリーリストで管理するアロケータ。
+  // 解放されたブロックは同じサイズクラスで再利用され、アリーナ自体は断片化しない。
+  // サイズクラスは2のべき乗を4分割した刻み (32,40,48,56,64,80,...) で、無駄は最大25%。
+  // 対象外のAllocationSourceの要求やアリーナに入らない要求は通常のヒープに回す。
+  // スレッドセーフではないため、複数のタスクから使う場合は呼出し側で排他すること。
+  /// Size-class pool over one fixed arena. Freed blocks are kept on per-class free lists and reused,
+  /// so creating and deleting sprites of similar sizes does not fragment memory.
+  /// Requests the arena cannot serve fall back to the platform heap and are counted in the statistics.
+  /// Psram requests that the heap cannot serve (e.g. no PSRAM fitted) are counted as psram misses,
+  /// not failures, since the caller retries them from another source.
+  /// Not thread-safe.
+  class PoolAllocator : public IAllocator
+  {
+  public:
+    /// Allocates an arena of arena_size bytes from the given source (Dma arenas also serve Normal requests).
+    PoolAllocator(size_t arena_size, AllocationSource arena_source = AllocationSource::Dma);
+
+    /// Uses a caller-provided arena, which must stay valid while the allocator is used.
+    PoolAllocator(void* arena, size_t arena_size, AllocationSource arena_source = AllocationSource::Dma);
+
+    virtual ~PoolAllocator(void);
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+    void* allocate(size_t length, AllocationSource source) override;
+    void deallocate(void* buf) override;
+
+    /// True when buf lies inside the arena.
+    bool owns(const void* buf) const { return (size_t)((const uint8_t*)buf - _arena) < _arena_size; }
+
+    const allocator_stats_t& getStats(void) const { return _stats; }
+    void resetHighWater(void) { _stats.high_water = _stats.in_use; }
+
+    /// Block size that a request of length bytes occupies in the arena (0 when it is too large).
+    static size_t classSize(size_t length);
+
+  protected:
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr size_t MIN_CLASS = 32;
+    static constexpr uint_fast8_t CLASS_COUNT = 80;
+    // 要求サイズより大きなクラスのフリーリストを探す範囲 (4クラス = 最大2倍)
+    static constexpr uint_fast8_t CLASS_SEARCH = 4;
+
+    static uint_fast8_t class_index(size_t length);
+    static size_t class_size(uint_fast8_t index) { return (4 + (index & 3)) << ((index >> 2) + 3); }
+
+    void init_arena(void* arena, size_t arena_size);
+    bool accepts(AllocationSource source) const;
+    uint8_t* pop_free(uint_fast8_t index);
+
+    void* _arena_alloc = nullptr;  // 自前で確保したアリーナ (デストラクタで解放する)
+    uint8_t* _arena = nullptr;
+    size_t _arena_size = 0;
+    size_t _arena_pos = 0;
+    void* _free_list[CLASS_COUNT];
+    allocator_stats_t _stats;
+    AllocationSource _arena_source;
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -158,6 +158,7 @@ namespace lgfx
     PointerWrapper(const uint8_t* src, uint32_t length = ~0) : DataWrapper{}, _ptr { src }, _index { 0 }, _length { length } {}
     void set(const uint8_t* src, uint32_t length = ~0) { _ptr = src; _length = length; _index = 0; }
     int read(uint8_t *buf, uint32_t len) override {
+      if (_index >= _length) { return 0; } // skip() may have moved past the end
       if (len > _length - _index) { len = _length - _index; }
       memcpy_P(buf, &_ptr[_index], len);
       _index += len;
@@ -17,6 +17,7 @@ Contributors:
 /----------------------------------------------------------------------------*/
 
 #include "SpriteBuffer.hpp"
+#include "Allocator.hpp"
 
 #include "../../internal/algorithm.h"
 #include "../platforms/common.hpp"
@@ -122,17 +123,17 @@ namespace lgfx
     {
       default:
       case AllocationSource::Normal:
-        buffer = heap_alloc(length);
+        buffer = buffer_alloc(length, AllocationSource::Normal);
         break;
       case AllocationSource::Dma:
-        buffer = heap_alloc_dma(length);
+        buffer = buffer_alloc(length, AllocationSource::Dma);
         break;
       case AllocationSource::Psram:
-        buffer = heap_alloc_psram(length);
+        buffer = buffer_alloc(length, AllocationSource::Psram);
         if (!buffer)
         {
           _source = AllocationSource::Dma;
-          buffer = heap_alloc_dma(length);
+          buffer = buffer_alloc(length, AllocationSource::Dma);
         }
         break;
     }
@@ -147,7 +148,7 @@ namespace lgfx
     if ( _buffer != nullptr ) {
       if (_source != AllocationSource::Preallocated)
       {
-        heap_free(_buffer);
+        buffer_free(_buffer);
       }
       _buffer = nullptr;
     }
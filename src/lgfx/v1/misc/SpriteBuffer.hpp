@@ -75,6 +75,14 @@ namespace lgfx
 
     void release(void);
 
+    /// Exchanges the buffers without copying.
+    void swap(SpriteBuffer& rhs)
+    {
+      auto buffer = _buffer; _buffer = rhs._buffer; rhs._buffer = buffer;
+      auto length = _length; _length = rhs._length; rhs._length = length;
+      auto source = _source; _source = rhs._source; rhs._source = source;
+    }
+
     bool use_dma(void) const { return _source == AllocationSource::Dma; }
     bool use_memcpy(void) const { return _source != AllocationSource::Psram; }
   };
@@ -128,6 +128,20 @@ namespace lgfx
   }
   using namespace gradient_fill_styles;
 
+//----------------------------------------------------------------------------
+
+  namespace polygon_fill_rules
+  {
+    enum fill_rule_t : uint8_t
+    {
+      nonzero = 0,
+      evenodd = 1
+    };
+    static constexpr const fill_rule_t NONZERO = fill_rule_t::nonzero;
+    static constexpr const fill_rule_t EVENODD = fill_rule_t::evenodd;
+  }
+  using namespace polygon_fill_rules;
+
 //----------------------------------------------------------------------------
 
   namespace textdatum
@@ -20,6 +20,7 @@ Contributors:
 #include <string.h>
 
 #include "colortype.hpp"
+#include "pixelcopy_simd.hpp"
 
 namespace lgfx
 {
@@ -144,12 +145,22 @@ namespace lgfx
       auto s = static_cast<const uint8_t*>(param->src_data);
       auto d = static_cast<TDst*>(dst);
       auto pal = static_cast<const TPalette*>(param->palette);
-      uint32_t i = param->positions[0] * param->src_bits;
+      auto src_bits = param->src_bits;
+      uint32_t i = param->positions[0] * src_bits;
       param->positions[0] += last - index;
+      if (src_bits == 8)
+      {
+        s += i >> 3;
+        do {
+          d[index].set(color_convert<TDst, TPalette>(pal[*s++].get()));
+        } while (++index != last);
+        return index;
+      }
+      auto src_mask = param->src_mask;
       do {
         uint32_t raw = s[i >> 3];
-        i += param->src_bits;
-        raw = (raw >> (-i & 7)) & param->src_mask;
+        i += src_bits;
+        raw = (raw >> (-i & 7)) & src_mask;
         d[index].set(color_convert<TDst, TPalette>(pal[raw].get()));
       } while (++index != last);
       return index;
@@ -167,9 +178,11 @@ namespace lgfx
       }
       else
       {
-        do {
+        index += simd_copy_rgb<TDst, TSrc>(&d[index], &s[index], last - index);
+        for (; index != last; ++index)
+        {
           d[index].set(color_convert<TDst, TSrc>(s[index].get()));
-        } while (++index != last);
+        }
       }
       return last;
     }
@@ -202,6 +215,19 @@ namespace lgfx
       auto src_y32_add = param->src_y32_add;
       auto src_x32 = param->src_x32;
       auto src_y32 = param->src_y32;
+      // unit step with no reachable transparent value : convert the whole run at once.
+      if (src_y32_add == 0 && src_x32_add == (1u << FP_SCALE) && TSrc::bits <= 24 && (param->transp >> 24))
+      {
+        uint32_t i = (src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_bitwidth;
+        uint32_t n = simd_copy_rgb<TDst, TSrc>(&d[index], &s[i], last - index);
+        index += n;
+        src_x32 += n << FP_SCALE;
+        if (index == last)
+        {
+          param->src_x32 = src_x32;
+          return index;
+        }
+      }
       do {
         uint32_t i = (src_x32 >> FP_SCALE) + (src_y32 >> FP_SCALE) * src_bitwidth;
         uint32_t raw = s[i].get();
@@ -456,6 +482,13 @@ namespace lgfx
       auto src_x32_add = param->src_x32_add;
       auto src_y32_add = param->src_y32_add;
       auto s = static_cast<const TSrc*>(param->src_data);
+      if (src_y32_add == 0 && src_x32_add == (1u << FP_SCALE))
+      {
+        uint32_t n = simd_blend_rgb<TDst, TSrc>(&d[index], &s[param->src_x + param->src_y * param->src_bitwidth], last - index);
+        param->src_x32 += n << FP_SCALE;
+        index += n;
+        if (index == last) return last;
+      }
       for (;;) {
         uint32_t i = param->src_x + param->src_y * param->src_bitwidth;
         uint_fast16_t a = s[i].a;
@@ -0,0 +1,357 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [BSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include <string.h>
+
+#include "colortype.hpp"
+
+/// Vector kernels used by pixelcopy_t for the most frequent format pairs.
+/// Selected at compile time. define LGFX_DISABLE_SIMD to use the scalar code only.
+#if !defined ( LGFX_DISABLE_SIMD )
+ #if defined ( __SSE2__ ) || defined ( _M_X64 ) || ( defined ( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+  #define LGFX_SIMD_SSE2
+  #include <emmintrin.h>
+ #elif defined ( __ARM_NEON ) || defined ( __ARM_NEON__ )
+  #define LGFX_SIMD_NEON
+  #include <arm_neon.h>
+ #endif
+#endif
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  /// Each kernel converts the leading part of a run of `len` pixels and returns
+  /// the number of pixels processed. The remaining pixels are left to the scalar loop.
+  template <typename TDst, typename TSrc>
+  static inline uint32_t simd_copy_rgb(TDst*, const TSrc*, uint32_t) { return 0; }
+
+  template <typename TDst, typename TSrc>
+  static inline uint32_t simd_blend_rgb(TDst*, const TSrc*, uint32_t) { return 0; }
+
+#if defined ( LGFX_SIMD_SSE2 )
+
+  namespace simd_sse2
+  {
+    static inline __m128i mask16(uint16_t m) { return _mm_set1_epi16(m); }
+    static inline __m128i mask32(uint32_t m) { return _mm_set1_epi32(m); }
+
+    /// 4 pixels of bgr888 (12 bytes) -> 4 x uint32 (0x00BBGGRR). reads 16 bytes.
+    static inline __m128i load_bgr888x4(const void* src)
+    {
+      __m128i v = _mm_loadu_si128(static_cast<const __m128i*>(src));
+      __m128i p01 = _mm_unpacklo_epi32(v, _mm_srli_si128(v, 3));
+      __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(v, 6), _mm_srli_si128(v, 9));
+      return _mm_and_si128(_mm_unpacklo_epi64(p01, p23), mask32(0x00FFFFFF));
+    }
+
+    /// 4 x uint32 (0x00BBGGRR) -> 4 pixels of bgr888. writes exactly 12 bytes.
+    static inline void store_bgr888x4(void* dst, __m128i v)
+    {
+      __m128i lo = _mm_set_epi32(0, ~0, 0, ~0);
+      v = _mm_or_si128(_mm_and_si128(v, lo), _mm_srli_epi64(_mm_andnot_si128(lo, v), 8));
+      __m128i lo64 = _mm_set_epi32(0, 0, ~0, ~0);
+      v = _mm_or_si128(_mm_and_si128(v, lo64), _mm_srli_si128(_mm_andnot_si128(lo64, v), 2));
+      auto d = static_cast<uint8_t*>(dst);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(d), v);
+      uint32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+      memcpy(&d[8], &tail, 4);
+    }
+
+    /// swap565 -> R8 / G8 / B8 (16bit lanes)
+    static inline void unpack_swap565(__m128i v, __m128i& r, __m128i& g, __m128i& b)
+    {
+      r = _mm_and_si128(_mm_srli_epi16(v, 3), mask16(0x1F));
+      b = _mm_and_si128(_mm_srli_epi16(v, 8), mask16(0x1F));
+      g = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, mask16(7)), 3), _mm_srli_epi16(v, 13));
+      r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+      b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+      g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+    }
+
+    /// R8 / G8 / B8 (16bit lanes) -> swap565
+    static inline __m128i pack_swap565(__m128i r, __m128i g, __m128i b)
+    {
+      __m128i res = _mm_slli_epi16(_mm_and_si128(g, mask16(0x1C)), 11);
+      res = _mm_or_si128(res, _mm_slli_epi16(_mm_and_si128(b, mask16(0xF8)), 5));
+      res = _mm_or_si128(res, _mm_and_si128(r, mask16(0xF8)));
+      return _mm_or_si128(res, _mm_srli_epi16(g, 5));
+    }
+
+    /// R8 / G8 / B8 (16bit lanes) -> 8 pixels of bgr888 (24 bytes)
+    static inline void store_bgr888x8(void* dst, __m128i r, __m128i g, __m128i b)
+    {
+      __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+      store_bgr888x4(dst                               , _mm_unpacklo_epi16(rg, b));
+      store_bgr888x4(&static_cast<uint8_t*>(dst)[12], _mm_unpackhi_epi16(rg, b));
+    }
+
+    /// 8 pixels of bgr888 -> R8 / G8 / B8 (16bit lanes). reads 28 bytes.
+    static inline void load_bgr888x8(const void* src, __m128i& r, __m128i& g, __m128i& b)
+    {
+      __m128i lo = load_bgr888x4(src);
+      __m128i hi = load_bgr888x4(&static_cast<const uint8_t*>(src)[12]);
+      __m128i m8 = mask32(0xFF);
+      r = _mm_packs_epi32(_mm_and_si128(lo, m8), _mm_and_si128(hi, m8));
+      g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), m8), _mm_and_si128(_mm_srli_epi32(hi, 8), m8));
+      b = _mm_packs_epi32(_mm_srli_epi32(lo, 16), _mm_srli_epi32(hi, 16));
+    }
+
+    /// 8 pixels of argb8888 -> A8 / R8 / G8 / B8 (16bit lanes)
+    static inline void load_argb8888x8(const void* src, __m128i& a, __m128i& r, __m128i& g, __m128i& b)
+    {
+      auto s = static_cast<const __m128i*>(src);
+      __m128i lo = _mm_loadu_si128(&s[0]);
+      __m128i hi = _mm_loadu_si128(&s[1]);
+      __m128i m8 = mask32(0xFF);
+      a = _mm_packs_epi32(_mm_srli_epi32(lo, 24), _mm_srli_epi32(hi, 24));
+      r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), m8), _mm_and_si128(_mm_srli_epi32(hi, 16), m8));
+      g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo,  8), m8), _mm_and_si128(_mm_srli_epi32(hi,  8), m8));
+      b = _mm_packs_epi32(_mm_and_si128(lo, m8), _mm_and_si128(hi, m8));
+    }
+
+    /// same result as the scalar blend in pixelcopy_t::blend_rgb_fast.
+    static inline __m128i blend8(__m128i d, __m128i s, __m128i inv, __m128i a1, __m128i opaque)
+    {
+      __m128i res = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(d, inv), _mm_mullo_epi16(s, a1)), 8);
+      return _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, res));
+    }
+  }
+
+  template <>
+  inline uint32_t simd_copy_rgb<bgr888_t, swap565_t>(bgr888_t* dst, const swap565_t* src, uint32_t len)
+  {
+    using namespace simd_sse2;
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      __m128i r, g, b;
+      unpack_swap565(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i])), r, g, b);
+      store_bgr888x8(&dst[i], r, g, b);
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_copy_rgb<swap565_t, bgr888_t>(swap565_t* dst, const bgr888_t* src, uint32_t len)
+  {
+    using namespace simd_sse2;
+    uint32_t i = 0;
+    for (; i + 10 <= len; i += 8)
+    {
+      __m128i r, g, b;
+      load_bgr888x8(&src[i], r, g, b);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]), pack_swap565(r, g, b));
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_copy_rgb<swap565_t, rgb332_t>(swap565_t* dst, const rgb332_t* src, uint32_t len)
+  {
+    using namespace simd_sse2;
+    __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      __m128i c = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&src[i])), zero);
+      __m128i r = _mm_and_si128(_mm_srli_epi16(c, 5), mask16(7));
+      __m128i g = _mm_and_si128(_mm_srli_epi16(c, 2), mask16(7));
+      __m128i b = _mm_and_si128(c, mask16(3));
+      r = _mm_or_si128(_mm_slli_epi16(r, 2), _mm_srli_epi16(r, 1));
+      b = _mm_add_epi16(_mm_mullo_epi16(b, mask16(10)), _mm_srli_epi16(b, 1));
+      __m128i res = _mm_or_si128(_mm_slli_epi16(g, 13), g);
+      res = _mm_or_si128(res, _mm_slli_epi16(b, 8));
+      res = _mm_or_si128(res, _mm_slli_epi16(r, 3));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&dst[i]), res);
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_blend_rgb<swap565_t, argb8888_t>(swap565_t* dst, const argb8888_t* src, uint32_t len)
+  {
+    using namespace simd_sse2;
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      __m128i sa, sr, sg, sb;
+      load_argb8888x8(&src[i], sa, sr, sg, sb);
+      auto d = reinterpret_cast<__m128i*>(&dst[i]);
+      __m128i dr, dg, db;
+      unpack_swap565(_mm_loadu_si128(d), dr, dg, db);
+      __m128i inv = _mm_sub_epi16(mask16(256), sa);
+      __m128i a1 = _mm_add_epi16(sa, mask16(1));
+      __m128i opaque = _mm_cmpeq_epi16(sa, mask16(255));
+      _mm_storeu_si128(d, pack_swap565( blend8(dr, sr, inv, a1, opaque)
+                                      , blend8(dg, sg, inv, a1, opaque)
+                                      , blend8(db, sb, inv, a1, opaque)));
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_blend_rgb<bgr888_t, argb8888_t>(bgr888_t* dst, const argb8888_t* src, uint32_t len)
+  {
+    using namespace simd_sse2;
+    uint32_t i = 0;
+    for (; i + 10 <= len; i += 8)
+    {
+      __m128i sa, sr, sg, sb;
+      load_argb8888x8(&src[i], sa, sr, sg, sb);
+      __m128i dr, dg, db;
+      load_bgr888x8(&dst[i], dr, dg, db);
+      __m128i inv = _mm_sub_epi16(mask16(256), sa);
+      __m128i a1 = _mm_add_epi16(sa, mask16(1));
+      __m128i opaque = _mm_cmpeq_epi16(sa, mask16(255));
+      store_bgr888x8(&dst[i], blend8(dr, sr, inv, a1, opaque)
+                            , blend8(dg, sg, inv, a1, opaque)
+                            , blend8(db, sb, inv, a1, opaque));
+    }
+    return i;
+  }
+
+#elif defined ( LGFX_SIMD_NEON )
+
+  namespace simd_neon
+  {
+    static inline void unpack_swap565(uint16x8_t v, uint16x8_t& r, uint16x8_t& g, uint16x8_t& b)
+    {
+      r = vandq_u16(vshrq_n_u16(v, 3), vdupq_n_u16(0x1F));
+      b = vandq_u16(vshrq_n_u16(v, 8), vdupq_n_u16(0x1F));
+      g = vorrq_u16(vshlq_n_u16(vandq_u16(v, vdupq_n_u16(7)), 3), vshrq_n_u16(v, 13));
+      r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+      b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+      g = vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4));
+    }
+
+    static inline uint16x8_t pack_swap565(uint16x8_t r, uint16x8_t g, uint16x8_t b)
+    {
+      uint16x8_t res = vshlq_n_u16(vandq_u16(g, vdupq_n_u16(0x1C)), 11);
+      res = vorrq_u16(res, vshlq_n_u16(vandq_u16(b, vdupq_n_u16(0xF8)), 5));
+      res = vorrq_u16(res, vandq_u16(r, vdupq_n_u16(0xF8)));
+      return vorrq_u16(res, vshrq_n_u16(g, 5));
+    }
+
+    static inline uint16x8_t blend8(uint16x8_t d, uint16x8_t s, uint16x8_t inv, uint16x8_t a1, uint16x8_t opaque)
+    {
+      uint16x8_t res = vshrq_n_u16(vmlaq_u16(vmulq_u16(d, inv), s, a1), 8);
+      return vbslq_u16(opaque, s, res);
+    }
+  }
+
+  template <>
+  inline uint32_t simd_copy_rgb<bgr888_t, swap565_t>(bgr888_t* dst, const swap565_t* src, uint32_t len)
+  {
+    using namespace simd_neon;
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      uint16x8_t r, g, b;
+      unpack_swap565(vld1q_u16(reinterpret_cast<const uint16_t*>(&src[i])), r, g, b);
+      uint8x8x3_t rgb = {{ vmovn_u16(r), vmovn_u16(g), vmovn_u16(b) }};
+      vst3_u8(reinterpret_cast<uint8_t*>(&dst[i]), rgb);
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_copy_rgb<swap565_t, bgr888_t>(swap565_t* dst, const bgr888_t* src, uint32_t len)
+  {
+    using namespace simd_neon;
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      uint8x8x3_t rgb = vld3_u8(reinterpret_cast<const uint8_t*>(&src[i]));
+      vst1q_u16(reinterpret_cast<uint16_t*>(&dst[i]), pack_swap565(vmovl_u8(rgb.val[0]), vmovl_u8(rgb.val[1]), vmovl_u8(rgb.val[2])));
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_copy_rgb<swap565_t, rgb332_t>(swap565_t* dst, const rgb332_t* src, uint32_t len)
+  {
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      uint16x8_t c = vmovl_u8(vld1_u8(reinterpret_cast<const uint8_t*>(&src[i])));
+      uint16x8_t r = vandq_u16(vshrq_n_u16(c, 5), vdupq_n_u16(7));
+      uint16x8_t g = vandq_u16(vshrq_n_u16(c, 2), vdupq_n_u16(7));
+      uint16x8_t b = vandq_u16(c, vdupq_n_u16(3));
+      r = vorrq_u16(vshlq_n_u16(r, 2), vshrq_n_u16(r, 1));
+      b = vaddq_u16(vmulq_n_u16(b, 10), vshrq_n_u16(b, 1));
+      uint16x8_t res = vorrq_u16(vshlq_n_u16(g, 13), g);
+      res = vorrq_u16(res, vshlq_n_u16(b, 8));
+      res = vorrq_u16(res, vshlq_n_u16(r, 3));
+      vst1q_u16(reinterpret_cast<uint16_t*>(&dst[i]), res);
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_blend_rgb<swap565_t, argb8888_t>(swap565_t* dst, const argb8888_t* src, uint32_t len)
+  {
+    using namespace simd_neon;
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      uint8x8x4_t bgra = vld4_u8(reinterpret_cast<const uint8_t*>(&src[i]));
+      auto d = reinterpret_cast<uint16_t*>(&dst[i]);
+      uint16x8_t dr, dg, db;
+      unpack_swap565(vld1q_u16(d), dr, dg, db);
+      uint16x8_t sa = vmovl_u8(bgra.val[3]);
+      uint16x8_t inv = vsubq_u16(vdupq_n_u16(256), sa);
+      uint16x8_t a1 = vaddq_u16(sa, vdupq_n_u16(1));
+      uint16x8_t opaque = vceqq_u16(sa, vdupq_n_u16(255));
+      vst1q_u16(d, pack_swap565( blend8(dr, vmovl_u8(bgra.val[2]), inv, a1, opaque)
+                               , blend8(dg, vmovl_u8(bgra.val[1]), inv, a1, opaque)
+                               , blend8(db, vmovl_u8(bgra.val[0]), inv, a1, opaque)));
+    }
+    return i;
+  }
+
+  template <>
+  inline uint32_t simd_blend_rgb<bgr888_t, argb8888_t>(bgr888_t* dst, const argb8888_t* src, uint32_t len)
+  {
+    using namespace simd_neon;
+    uint32_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+      uint8x8x4_t bgra = vld4_u8(reinterpret_cast<const uint8_t*>(&src[i]));
+      auto d = reinterpret_cast<uint8_t*>(&dst[i]);
+      uint8x8x3_t rgb = vld3_u8(d);
+      uint16x8_t sa = vmovl_u8(bgra.val[3]);
+      uint16x8_t inv = vsubq_u16(vdupq_n_u16(256), sa);
+      uint16x8_t a1 = vaddq_u16(sa, vdupq_n_u16(1));
+      uint16x8_t opaque = vceqq_u16(sa, vdupq_n_u16(255));
+      rgb.val[0] = vmovn_u16(blend8(vmovl_u8(rgb.val[0]), vmovl_u8(bgra.val[2]), inv, a1, opaque));
+      rgb.val[1] = vmovn_u16(blend8(vmovl_u8(rgb.val[1]), vmovl_u8(bgra.val[1]), inv, a1, opaque));
+      rgb.val[2] = vmovn_u16(blend8(vmovl_u8(rgb.val[2]), vmovl_u8(bgra.val[0]), inv, a1, opaque));
+      vst3_u8(d, rgb);
+    }
+    return i;
+  }
+
+#endif
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -18,6 +18,7 @@ Contributors:
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
 namespace lgfx
 {
@@ -79,6 +80,129 @@ namespace lgfx
   };
 #pragma pack(pop)
 
+  struct point_t
+  {
+    int32_t x;
+    int32_t y;
+  };
+
+  struct pointf_t
+  {
+    float x;
+    float y;
+  };
+
+  // 同色でまとめて塗り潰す矩形 (クリップ済みの座標)
+  struct fill_rect_t
+  {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+  };
+
+//----------------------------------------------------------------------------
+
+// 更新範囲を最大N個の矩形で保持する。重なる矩形は統合し、満杯の場合は面積の増加が最小の矩形へ統合する。
+/// Keeps a modified area as up to N rectangles.
+/// Overlapping rectangles are merged, and when full the new one is merged into the rectangle that grows the least.
+  template <size_t N>
+  struct range_rect_list_t
+  {
+    range_rect_t rects[N];
+    size_t count = 0;
+
+    bool empty(void) const { return count == 0; }
+    void clear(void) { count = 0; }
+    const range_rect_t& back(void) const { return rects[count - 1]; }
+    void pop_back(void) { --count; }
+
+    bool intersectsWith(int_fast16_t left, int_fast16_t top, int_fast16_t right, int_fast16_t bottom) const
+    {
+      for (size_t i = 0; i < count; ++i)
+      {
+        auto& r = rects[i];
+        if (r.horizon.intersectsWith(left, right) && r.vertical.intersectsWith(top, bottom)) { return true; }
+      }
+      return false;
+    }
+
+    range_rect_t bounds(void) const
+    {
+      range_rect_t res;
+      res.left  = res.top    = INT16_MAX;
+      res.right = res.bottom = -1;
+      for (size_t i = 0; i < count; ++i)
+      {
+        auto& r = rects[i];
+        if (res.left   > r.left  ) { res.left   = r.left;   }
+        if (res.right  < r.right ) { res.right  = r.right;  }
+        if (res.top    > r.top   ) { res.top    = r.top;    }
+        if (res.bottom < r.bottom) { res.bottom = r.bottom; }
+      }
+      return res;
+    }
+
+    void add(int_fast16_t left, int_fast16_t top, int_fast16_t right, int_fast16_t bottom)
+    {
+      if (left > right || top > bottom) { return; }
+      range_rect_t n;
+      n.left = left;
+      n.right = right;
+      n.top = top;
+      n.bottom = bottom;
+
+      for (;;)
+      {
+        size_t i = 0;
+        while (i < count)
+        { // 統合しても無駄な領域が増えない矩形を吸収する
+          auto& r = rects[i];
+          int32_t merged = _union_area(r, n);
+          if (merged <= _area(r) + _area(n))
+          {
+            _merge(n, r);
+            rects[i] = rects[--count];
+            i = 0;
+            continue;
+          }
+          ++i;
+        }
+        if (count < N)
+        {
+          rects[count++] = n;
+          return;
+        }
+        size_t best = 0;
+        int32_t best_cost = INT32_MAX;
+        for (i = 0; i < count; ++i)
+        {
+          int32_t cost = _union_area(rects[i], n) - _area(rects[i]);
+          if (best_cost > cost) { best_cost = cost; best = i; }
+        }
+        // 統合で大きくなった矩形が他の矩形を吸収できる場合があるため、取り出して追加し直す
+        _merge(n, rects[best]);
+        rects[best] = rects[--count];
+      }
+    }
+
+  private:
+    static int32_t _area(const range_rect_t& r) { return (int32_t)r.width() * r.height(); }
+    static int32_t _union_area(const range_rect_t& a, const range_rect_t& b)
+    {
+      int32_t w = (a.right  > b.right  ? a.right  : b.right ) - (a.left < b.left ? a.left : b.left) + 1;
+      int32_t h = (a.bottom > b.bottom ? a.bottom : b.bottom) - (a.top  < b.top  ? a.top  : b.top ) + 1;
+      return w * h;
+    }
+    static void _merge(range_rect_t& dst, const range_rect_t& src)
+    {
+      if (dst.left   > src.left  ) { dst.left   = src.left;   }
+      if (dst.right  < src.right ) { dst.right  = src.right;  }
+      if (dst.top    > src.top   ) { dst.top    = src.top;    }
+      if (dst.bottom < src.bottom) { dst.bottom = src.bottom; }
+    }
+  };
+
 //----------------------------------------------------------------------------
  }
 }
@@ -136,6 +136,32 @@ namespace lgfx
     }
   }
 
+  void Panel_FrameBufferBase::writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t rawcolor)
+  {
+    if (_internal_rotation || _write_bits < 8)
+    {
+      for (size_t i = 0; i < count; ++i)
+      {
+        auto& r = rects[i];
+        Panel_FrameBufferBase::writeFillRectPreclipped(r.x, r.y, r.w, r.h, rawcolor);
+      }
+      return;
+    }
+    size_t bytes = _write_bits >> 3;
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto& r = rects[i];
+      uint_fast16_t y = r.y;
+      uint_fast16_t ye = y + r.h;
+      do
+      {
+        auto ptr = &_lines_buffer[y][r.x * bytes];
+        memset_multi(ptr, rawcolor, bytes, r.w);
+        cacheWriteBack(ptr, bytes * r.w);
+      } while (++y < ye);
+    }
+  }
+
   void Panel_FrameBufferBase::writeBlock(uint32_t rawcolor, uint32_t length)
   {
     do
@@ -75,13 +75,11 @@ namespace lgfx
 
     setRotation(_rotation);
 
-    _range_old.top = 0;
-    _range_old.left = 0;
-    _range_old.right = _width - 1;
-    _range_old.bottom = _height - 1;
+    _range_old.clear();
+    _range_old.add(0, 0, _width - 1, _height - 1);
     _exec_transfer(0x13, _range_old);
     _close_transfer();
-    _range_mod = _range_old;
+    _range_mod.clear();
 
     endWrite();
 
@@ -102,18 +100,21 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int16_t>(_range_mod.bottom, y + h - 1);
+      _range_mod.add(x & ~7, y, (x + w - 1) | 7, y + h - 1);
     }
     if (_range_mod.empty()) { return; }
     _close_transfer();
     _range_old = _range_mod;
+
+    // 複数の矩形を転送した場合、リフレッシュは全体を囲む範囲に対して行う。
+    // 範囲内の転送しなかった部分は新旧のデータが一致しているため表示は変化しない。
+    bool multi = _range_mod.count > 1;
+    auto bounds = _range_mod.bounds();
     while (millis() - _send_msec < _refresh_msec) delay(1);
     if (getEpdMode() == epd_mode_t::epd_quality)
     {
       _exec_transfer(0x13, _range_mod, true);
+      if (multi) { _set_partial_window(bounds); }
       _wait_busy();
       _bus->writeCommand(0x12, 8);
       auto send_msec = millis();
@@ -122,10 +123,8 @@ namespace lgfx
       _exec_transfer(0x10, _range_mod, true);
     }
     _exec_transfer(0x13, _range_mod);
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+    if (multi) { _set_partial_window(bounds); }
+    _range_mod.clear();
 
     _wait_busy();
     _bus->writeCommand(0x12, 8);
@@ -328,7 +327,7 @@ namespace lgfx
     return _buf[idx >> 3] & (0x80 >> (idx & 7));
   }
 
-  void Panel_GDEW0154M09::_exec_transfer(uint32_t cmd, const range_rect_t& range, bool invert)
+  void Panel_GDEW0154M09::_set_partial_window(const range_rect_t& range)
   {
     int32_t xs = range.left & ~7;
     int32_t xe = range.right & ~7;
@@ -342,6 +341,22 @@ namespace lgfx
     _bus->writeData(xs | xe << 8, 16);
     _bus->writeData(getSwap16(range.top) | getSwap16(range.bottom)<<16, 32);
     _bus->writeData(1, 8);
+  }
+
+  void Panel_GDEW0154M09::_exec_transfer(uint32_t cmd, const range_rect_list_t<modified_rect_max>& list, bool invert)
+  {
+    for (size_t i = 0; i < list.count; ++i)
+    {
+      _exec_transfer(cmd, list.rects[i], invert);
+    }
+  }
+
+  void Panel_GDEW0154M09::_exec_transfer(uint32_t cmd, const range_rect_t& range, bool invert)
+  {
+    int32_t xs = range.left & ~7;
+    int32_t xe = range.right & ~7;
+
+    _set_partial_window(range);
 
     _wait_busy();
 
@@ -383,10 +398,7 @@ namespace lgfx
     if (_range_old.empty()) { return; }
     while (millis() - _send_msec < _refresh_msec) delay(1);
     _exec_transfer(0x10, _range_old);
-    _range_old.top    = INT16_MAX;
-    _range_old.left   = INT16_MAX;
-    _range_old.right  = 0;
-    _range_old.bottom = 0;
+    _range_old.clear();
 
     _bus->wait();
   }
@@ -398,14 +410,11 @@ namespace lgfx
     int32_t x1 = xs & ~7;
     int32_t x2 = (xe & ~7) + 7;
 
-    if (_range_old.horizon.intersectsWith(x1, x2) && _range_old.vertical.intersectsWith(ys, ye))
+    if (_range_old.intersectsWith(x1, ys, x2, ye))
     {
       _close_transfer();
     }
-    _range_mod.top    = std::min<int32_t>(ys, _range_mod.top);
-    _range_mod.left   = std::min<int32_t>(x1, _range_mod.left);
-    _range_mod.right  = std::max<int32_t>(x2, _range_mod.right);
-    _range_mod.bottom = std::max<int32_t>(ye, _range_mod.bottom);
+    _range_mod.add(x1, ys, x2, ye);
   }
 
 //----------------------------------------------------------------------------
@@ -55,7 +55,7 @@ namespace lgfx
 
     static constexpr unsigned long _refresh_msec = 320;
 
-    range_rect_t _range_old;
+    range_rect_list_t<modified_rect_max> _range_old;
     unsigned long _send_msec = 0;
 
     size_t _get_buffer_length(void) const override;
@@ -64,7 +64,9 @@ namespace lgfx
     void _draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t value);
     bool _read_pixel(uint_fast16_t x, uint_fast16_t y);
     void _update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye);
+    void _set_partial_window(const range_rect_t& range);
     void _exec_transfer(uint32_t cmd, const range_rect_t& range, bool invert = false);
+    void _exec_transfer(uint32_t cmd, const range_rect_list_t<modified_rect_max>& list, bool invert = false);
     void _close_transfer(void);
 
     const uint8_t* getInitCommands(uint8_t listno) const override
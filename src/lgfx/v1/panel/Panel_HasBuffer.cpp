@@ -38,10 +38,7 @@ namespace lgfx
 
   bool Panel_HasBuffer::init(bool use_reset)
   {
-    _range_mod.top = INT16_MAX;
-    _range_mod.left = INT16_MAX;
-    _range_mod.right = 0;
-    _range_mod.bottom = 0;
+    _range_mod.clear();
 
     auto len = _get_buffer_length();
     if (_buf) heap_free(_buf);
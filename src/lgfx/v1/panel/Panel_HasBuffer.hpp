@@ -45,8 +45,13 @@ namespace lgfx
     void writeBlock(uint32_t rawcolor, uint32_t length) override;
 
   protected:
+    // 更新範囲は最大 modified_rect_max 個の矩形で保持し、display() で矩形ごとに転送する
+    /// The modified area is kept as up to modified_rect_max rectangles (panel coordinates),
+    /// and display() transfers each of them separately.
+    static constexpr size_t modified_rect_max = 4;
+
     uint8_t* _buf = nullptr;
-    range_rect_t _range_mod;
+    range_rect_list_t<modified_rect_max> _range_mod;
     int32_t _xpos = 0;
     int32_t _ypos = 0;
     bool _in_transaction = false;
@@ -0,0 +1,196 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#if defined ( __linux__ ) || defined ( __APPLE__ ) || defined ( _WIN32 )
+
+#include "Panel_Headless.hpp"
+#include "../platforms/common.hpp"
+#include "../misc/pixelcopy.hpp"
+#include "../../utility/lgfx_miniz.h"
+#include "../../utility/lgfx_qoi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+  Panel_Headless::~Panel_Headless(void)
+  {
+    deinitFrameBuffer();
+  }
+
+  bool Panel_Headless::init(bool use_reset)
+  {
+    deinitFrameBuffer();
+
+    size_t height = _cfg.panel_height;
+    /// 24bit color + 8byte alignment;
+    _frame_stride = (_cfg.panel_width * 3 + 7) & ~7u;
+
+    _lines_buffer = (uint8_t**)heap_alloc_dma(height * sizeof(uint8_t*));
+    _framebuffer = (uint8_t*)heap_alloc_dma(_frame_stride * height);
+    if (_lines_buffer == nullptr || _framebuffer == nullptr)
+    {
+      deinitFrameBuffer();
+      return false;
+    }
+    memset(_framebuffer, 0, _frame_stride * height);
+    for (size_t y = 0; y < height; ++y)
+    {
+      _lines_buffer[y] = &_framebuffer[y * _frame_stride];
+    }
+    _frame_count = 0;
+
+    return Panel_FrameBufferBase::init(use_reset);
+  }
+
+  void Panel_Headless::deinitFrameBuffer(void)
+  {
+    if (_lines_buffer)
+    {
+      heap_free(_lines_buffer);
+      _lines_buffer = nullptr;
+    }
+    if (_framebuffer)
+    {
+      heap_free(_framebuffer);
+      _framebuffer = nullptr;
+    }
+  }
+
+  color_depth_t Panel_Headless::setColorDepth(color_depth_t depth)
+  {
+    auto bits = depth & color_depth_t::bit_mask;
+    if (bits >= 16) {
+      depth = (bits > 16)
+            ? rgb888_3Byte
+            : rgb565_2Byte;
+    } else {
+      depth = (depth == color_depth_t::grayscale_8bit)
+            ? grayscale_8bit
+            : rgb332_1Byte;
+    }
+    _write_depth = depth;
+    _read_depth = depth;
+
+    return depth;
+  }
+
+  void Panel_Headless::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    (void)x;
+    (void)y;
+    (void)w;
+    (void)h;
+
+    uint32_t frame = _frame_count++;
+    if (_dump_format == dump_none) { return; }
+    if (_dump_callback == nullptr && _dump_path == nullptr) { return; }
+
+    size_t len = 0;
+    void* data = createFrameImage(&len, _dump_format);
+    if (data == nullptr) { return; }
+
+    if (_dump_callback)
+    {
+      _dump_callback(data, len, frame, _dump_user_data);
+    }
+    else
+    {
+      char filename[256];
+      snprintf(filename, sizeof(filename), _dump_path, frame);
+      FILE* fp = fopen(filename, "wb");
+      if (fp)
+      {
+        fwrite(data, 1, len, fp);
+        fclose(fp);
+      }
+    }
+    free(data);
+  }
+
+  struct frame_encoder_t
+  {
+    const Panel_Headless* panel;
+    pixelcopy_t* pc;
+  };
+
+  static uint8_t* frame_encoder_get_row(uint8_t* lineBuffer, int flip, int w, int h, int y, void* target)
+  {
+    auto enc = static_cast<frame_encoder_t*>(target);
+    uint32_t ypos = (flip ? (h - 1 - y) : y);
+    auto pc = enc->pc;
+    pc->src_x32 = 0;
+    pc->src_data = enc->panel->getFrameBuffer() + ypos * enc->panel->getFrameStride();
+    pc->fp_copy(lineBuffer, 0, w, pc);
+    return lineBuffer;
+  }
+
+  static uint8_t* frame_encoder_get_png_row(uint8_t* lineBuffer, int flip, int w, int h, int y, int, void* target)
+  {
+    return frame_encoder_get_row(lineBuffer, flip, w, h, y, target);
+  }
+
+  void* Panel_Headless::createFrameImage(size_t* datalen, dump_format_t format) const
+  {
+    *datalen = 0;
+    if (_framebuffer == nullptr || format == dump_none) { return nullptr; }
+
+    pixelcopy_t pc(nullptr, color_depth_t::rgb888_3Byte, _write_depth, false);
+    if (_write_depth == rgb565_2Byte) {
+      pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, swap565_t>;
+    } else if (_write_depth == rgb888_3Byte) {
+      pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, bgr888_t>;
+    } else if (_write_depth == rgb332_1Byte) {
+      pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, rgb332_t>;
+    } else if (_write_depth == grayscale_8bit) {
+      pc.fp_copy = pixelcopy_t::copy_rgb_fast<bgr888_t, grayscale_t>;
+    }
+
+    int w = _cfg.panel_width;
+    int h = _cfg.panel_height;
+    void* rgbBuffer = heap_alloc_dma(w * 3);
+    if (rgbBuffer == nullptr) { return nullptr; }
+
+    frame_encoder_t enc = { this, &pc };
+    void* res = nullptr;
+    if (format == dump_png)
+    {
+      res = tdefl_write_image_to_png_file_in_memory_ex_with_cb(rgbBuffer, w, h, 3, datalen, 6, 0, (tdefl_get_png_row_func)frame_encoder_get_png_row, &enc);
+    }
+    else
+    {
+      res = lgfx_qoi_encoder_write_fb(rgbBuffer, w, h, 3, datalen, 0, frame_encoder_get_row, &enc);
+      // the encoder returns a stale pointer when it fails before allocating.
+      if (*datalen == 0) { res = nullptr; }
+    }
+
+    heap_free(rgbBuffer);
+
+    return res;
+  }
+
+//----------------------------------------------------------------------------
+ }
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*----------------------------------------------------------------------------/
+  Lovyan GFX - Graphics library for embedded devices.
+
+Original Source:
+ https://github.com/lovyan03/LovyanGFX/
+
+Licence:
+ [FreeBSD](https://github.com/lovyan03/LovyanGFX/blob/master/license.txt)
+
+Author:
+ [lovyan03](https://twitter.com/lovyan03)
+
+Contributors:
+ [ciniml](https://github.com/ciniml)
+ [mongonta0716](https://github.com/mongonta0716)
+ [tobozo](https://github.com/tobozo)
+/----------------------------------------------------------------------------*/
+#pragma once
+
+#include "Panel_FrameBufferBase.hpp"
+
+#include <stddef.h>
+
+namespace lgfx
+{
+ inline namespace v1
+ {
+//----------------------------------------------------------------------------
+
+// 表示装置を持たず、RAM上のフレームバッファにのみ描画するパネル
+// display() の度に PNG / QOI 形式でフレームを出力できる。
+/// Panel without a display device. Frames are kept in RAM only,
+/// and can be written out as PNG / QOI on each display() call.
+
+  struct Panel_Headless : public Panel_FrameBufferBase
+  {
+  public:
+    enum dump_format_t
+    {
+      dump_none,
+      dump_png,
+      dump_qoi,
+    };
+
+    /// data is valid only during the callback.
+    typedef void (*dump_callback_t)(const void* data, size_t length, uint32_t frame, void* user_data);
+
+    Panel_Headless(void) = default;
+    virtual ~Panel_Headless(void);
+
+    bool init(bool use_reset) override;
+
+    color_depth_t setColorDepth(color_depth_t depth) override;
+
+    void display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h) override;
+
+    /// Frame memory in panel orientation, raw pixel format of getWriteDepth().
+    /// Rows are getFrameStride() bytes apart.
+    const uint8_t* getFrameBuffer(void) const { return _framebuffer; }
+    uint32_t getFrameStride(void) const { return _frame_stride; }
+
+    /// Number of display() calls since init.
+    uint32_t getFrameCount(void) const { return _frame_count; }
+
+    /// Select the output format for display(). (default: dump_none)
+    void setDumpFormat(dump_format_t format) { _dump_format = format; }
+    dump_format_t getDumpFormat(void) const { return _dump_format; }
+
+    /// printf style file name, receives the frame number. e.g. "frame_%05u.png"
+    void setDumpPath(const char* path_format) { _dump_path = path_format; }
+
+    /// Receive the encoded frame instead of writing a file.
+    void setDumpCallback(dump_callback_t callback, void* user_data = nullptr) { _dump_callback = callback; _dump_user_data = user_data; }
+
+    /// Encode the current frame. Release the result with free().
+    void* createFrameImage(size_t* datalen, dump_format_t format) const;
+
+  protected:
+    uint8_t* _framebuffer = nullptr;
+    uint32_t _frame_stride = 0;
+    uint32_t _frame_count = 0;
+
+    dump_format_t _dump_format = dump_none;
+    const char* _dump_path = nullptr;
+    dump_callback_t _dump_callback = nullptr;
+    void* _dump_user_data = nullptr;
+
+    void deinitFrameBuffer(void);
+  };
+
+//----------------------------------------------------------------------------
+ }
+}
@@ -127,10 +127,7 @@ IT8951 Registers defines
 
   bool Panel_IT8951::init(bool use_reset)
   {
-    _range_new.top = INT16_MAX;
-    _range_new.left = INT16_MAX;
-    _range_new.right = 0;
-    _range_new.bottom = 0;
+    _range_new.clear();
 
     if (!Panel_Device::init(use_reset))
     {
@@ -387,20 +384,13 @@ IT8951 Registers defines
       std::swap(rw, rh);
     }
 
-    _range_new.left   = std::min<uint32_t>(_range_new.left  , rx         );
-    _range_new.right  = std::max<uint32_t>(_range_new.right , rx + rw - 1);
-    _range_new.top    = std::min<uint32_t>(_range_new.top   , ry         );
-    _range_new.bottom = std::max<uint32_t>(_range_new.bottom, ry + rh - 1);
+    _range_new.add(rx, ry, rx + rw - 1, ry + rh - 1);
 
     if (_epd_mode != epd_mode_t::epd_fastest
-     && _range_old.horizon.intersectsWith(rx, rx + rw - 1)
-     && _range_old.vertical.intersectsWith(ry, ry + rh - 1))
+     && _range_old.intersectsWith(rx, ry, rx + rw - 1, ry + rh - 1))
     {
       _check_afsr();
-      _range_old.left = INT16_MAX;
-      _range_old.top = INT16_MAX;
-      _range_old.right = 0;
-      _range_old.bottom = 0;
+      _range_old.clear();
     }
 
     uint16_t params[5];
@@ -412,11 +402,11 @@ IT8951 Registers defines
     return _write_args(IT8951_TCON_LD_IMG_AREA, params, 5);
   }
 
-  bool Panel_IT8951::_update_raw_area(epd_update_mode_t mode)
+  bool Panel_IT8951::_update_raw_area(const range_rect_t& range, epd_update_mode_t mode)
   {
-    if (_range_new.empty()) return false;
-    uint32_t l = _range_new.left;
-    uint32_t r = _range_new.right;
+    if (range.empty()) return false;
+    uint32_t l = range.left;
+    uint32_t r = range.right;
 
     // 更新範囲の幅が小さすぎる場合、IT8951がフリーズすることがある。;
     // 厳密には、範囲の左右端の座標値の下2ビット捨てた場合に同値になる場合、;
@@ -436,9 +426,9 @@ IT8951 Registers defines
     uint32_t w = r - l + 1;
     uint16_t params[7];
     params[0] = l;
-    params[1] = _range_new.top;
+    params[1] = range.top;
     params[2] = w;
-    params[3] = _range_new.bottom - _range_new.top + 1;
+    params[3] = range.bottom - range.top + 1;
     params[4] = mode;
     params[5] = (uint16_t)_tar_memaddr;
     params[6] = (uint16_t)(_tar_memaddr >> 16);
@@ -467,12 +457,11 @@ IT8951 Registers defines
     default:                       mode = UPDATE_MODE_GC16; break;
     }
 
-    _update_raw_area(mode);
-
-    _range_new.top = INT16_MAX;
-    _range_new.left = INT16_MAX;
-    _range_new.right = 0;
-    _range_new.bottom = 0;
+    for (size_t i = 0; i < _range_new.count; ++i)
+    {
+      _update_raw_area(_range_new.rects[i], mode);
+    }
+    _range_new.clear();
   }
 
   void Panel_IT8951::setInvert(bool invert)
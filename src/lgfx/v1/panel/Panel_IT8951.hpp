@@ -77,8 +77,9 @@ namespace lgfx
       UPDATE_MODE_NONE    = 8
     };        // The ones marked with * are more commonly used
 
-    range_rect_t _range_new;
-    range_rect_t _range_old;
+    // 更新範囲は最大4個の矩形で保持し、display() で矩形ごとに表示更新を行う
+    range_rect_list_t<4> _range_new;
+    range_rect_list_t<4> _range_old;
 
     uint16_t _xpos = 0;
     uint16_t _ypos = 0;
@@ -96,7 +97,7 @@ namespace lgfx
     bool _check_afsr( void );
     bool _set_target_memory_addr( uint32_t tar_addr);
     bool _set_area( uint32_t x, uint32_t y, uint32_t w, uint32_t h);
-    bool _update_raw_area( epd_update_mode_t mode);
+    bool _update_raw_area( const range_rect_t& range, epd_update_mode_t mode);
     bool _read_raw_line( int32_t raw_x, int32_t raw_y, int32_t len, uint16_t* buf);
 
     fastread_dir_t get_fastread_dir(void) const override { return _it8951_rotation & 1 ? fastread_vertical : fastread_horizontal; }
@@ -258,6 +258,33 @@ namespace lgfx
     _bus->writeDataRepeat(rawcolor, _write_bits, len);
   }
 
+  void Panel_LCD::writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t rawcolor)
+  {
+    if (count == 0) { return; }
+    // 同じ列範囲の矩形を並べて CASET の再送を省き、縦に隣接するものは一つの矩形に統合する
+    auto buf = (fill_rect_t*)alloca(count * sizeof(fill_rect_t));
+    auto key = [](const fill_rect_t& r) { return (uint64_t)r.x << 48 | (uint64_t)r.w << 32 | (uint32_t)r.y << 16 | r.h; };
+    for (size_t i = 0; i < count; ++i)
+    { // insertion sort, the batches are small
+      auto r = rects[i];
+      auto k = key(r);
+      size_t j = i;
+      for (; j && key(buf[j - 1]) > k; --j) buf[j] = buf[j - 1];
+      buf[j] = r;
+    }
+    size_t i = 0;
+    do
+    {
+      auto r = buf[i];
+      while (++i < count && buf[i].x == r.x && buf[i].w == r.w && buf[i].y <= r.y + r.h)
+      { // overlapping or adjacent rows
+        int32_t b = buf[i].y + buf[i].h;
+        if (b > r.y + r.h) r.h = b - r.y;
+      }
+      writeFillRectPreclipped(r.x, r.y, r.w, r.h, rawcolor);
+    } while (i < count);
+  }
+
   void Panel_LCD::writeBlock(uint32_t rawcolor, uint32_t len)
   {
     _bus->writeDataRepeat(rawcolor, _write_bits, len);
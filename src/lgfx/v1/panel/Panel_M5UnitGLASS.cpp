@@ -51,10 +51,7 @@ namespace lgfx
 
     if (!connected) { return false; }
 
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+    _range_mod.clear();
 
     setInvert(_invert);
     setRotation(_rotation);
@@ -88,22 +85,18 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int_fast16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int_fast16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int_fast16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int_fast16_t>(_range_mod.bottom, y + h - 1);
+      _add_modified_rect(x, y, x + w - 1, y + h - 1);
     }
     if (_range_mod.empty()) { return; }
 
-    uint_fast8_t xs = _range_mod.left;
-    uint_fast8_t xe = _range_mod.right;
-    uint_fast8_t ys = _range_mod.top    >> 3;
-    uint_fast8_t ye = _range_mod.bottom >> 3;
+    // 転送箇所は _modified_flags で8x8単位に判定するため、全体の範囲のみ使用する
+    auto range = _range_mod.bounds();
+    _range_mod.clear();
 
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+    uint_fast8_t xs = range.left;
+    uint_fast8_t xe = range.right;
+    uint_fast8_t ys = range.top    >> 3;
+    uint_fast8_t ye = range.bottom >> 3;
 
     y = ys;
     waitBusy();
@@ -255,10 +255,7 @@ namespace lgfx
   void Panel_1bitOLED::_update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye)
   {
     _rotate_pos(xs, ys, xe, ye);
-    _range_mod.left   = std::min<int32_t>(xs, _range_mod.left);
-    _range_mod.right  = std::max<int32_t>(xe, _range_mod.right);
-    _range_mod.top    = std::min<int32_t>(ys, _range_mod.top);
-    _range_mod.bottom = std::max<int32_t>(ye, _range_mod.bottom);
+    _add_modified_rect(xs, ys, xe, ye);
   }
 
 //----------------------------------------------------------------------------
@@ -294,35 +291,31 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int_fast16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int_fast16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int_fast16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int_fast16_t>(_range_mod.bottom, y + h - 1);
+      _add_modified_rect(x, y, x + w - 1, y + h - 1);
     }
-    if (_range_mod.empty()) { return; }
-
-    uint_fast8_t xs = _range_mod.left;
-    uint_fast8_t xe = _range_mod.right;
-    uint_fast8_t ys = _range_mod.top    >> 3;
-    uint_fast8_t ye = _range_mod.bottom >> 3;
-    int retry = 3;
-    while (!(_bus->writeCommand(CMD_COLUMNADDR| (xs +  _cfg.offset_x      ) << 8 | (xe +  _cfg.offset_x      ) << 16, 24)
-          && _bus->writeCommand(CMD_PAGEADDR  | (ys + (_cfg.offset_y >> 3)) << 8 | (ye + (_cfg.offset_y >> 3)) << 16, 24)) && --retry)
-    {
-      _bus->endTransaction();
-      _bus->beginTransaction();
-    }
-    if (retry)
+    // 更新矩形ごとにアドレス範囲を指定して転送する
+    while (!_range_mod.empty())
     {
+      auto& r = _range_mod.back();
+      uint_fast8_t xs = r.left;
+      uint_fast8_t xe = r.right;
+      uint_fast8_t ys = r.top    >> 3;
+      uint_fast8_t ye = r.bottom >> 3;
+      int retry = 3;
+      while (!(_bus->writeCommand(CMD_COLUMNADDR| (xs +  _cfg.offset_x      ) << 8 | (xe +  _cfg.offset_x      ) << 16, 24)
+            && _bus->writeCommand(CMD_PAGEADDR  | (ys + (_cfg.offset_y >> 3)) << 8 | (ye + (_cfg.offset_y >> 3)) << 16, 24)) && --retry)
+      {
+        _bus->endTransaction();
+        _bus->beginTransaction();
+      }
+      if (!retry) { return; }
+
       do
       {
         auto buf = &_buf[xs + ys * _cfg.panel_width];
         _bus->writeBytes(buf, xe - xs + 1, true, true);
       } while (++ys <= ye);
-      _range_mod.top    = INT16_MAX;
-      _range_mod.left   = INT16_MAX;
-      _range_mod.right  = 0;
-      _range_mod.bottom = 0;
+      _range_mod.pop_back();
     }
   }
 
@@ -339,42 +332,38 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int_fast16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int_fast16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int_fast16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int_fast16_t>(_range_mod.bottom, y + h - 1);
+      _add_modified_rect(x, y, x + w - 1, y + h - 1);
     }
-    if (_range_mod.empty()) { return; }
-
-    uint_fast8_t xs = _range_mod.left ;
-    uint_fast8_t xe = _range_mod.right;
-    uint_fast8_t ys = _range_mod.top    >> 3;
-    uint_fast8_t ye = _range_mod.bottom >> 3;
-
     uint_fast8_t offset_y = _cfg.offset_y >> 3;
-    uint_fast8_t offset_x = _cfg.offset_x + xs;
 
-    int retry = 3;
-    do
+    while (!_range_mod.empty())
     {
-      while (!_bus->writeCommand(  CMD_SETPAGEADDR | (ys + offset_y)
-                                | (CMD_SETHIGHCOLUMN + (offset_x >> 4)) << 8
-                                | (CMD_SETLOWCOLUMN  + (offset_x & 0x0F)) << 16
-                                , 24) && --retry)
+      auto& r = _range_mod.back();
+      uint_fast8_t xs = r.left ;
+      uint_fast8_t xe = r.right;
+      uint_fast8_t ys = r.top    >> 3;
+      uint_fast8_t ye = r.bottom >> 3;
+      uint_fast8_t offset_x = _cfg.offset_x + xs;
+
+      int retry = 3;
+      do
       {
-        _bus->endTransaction();
-        _bus->beginTransaction();
-      }
-      if (!retry) { break; }
+        while (!_bus->writeCommand(  CMD_SETPAGEADDR | (ys + offset_y)
+                                  | (CMD_SETHIGHCOLUMN + (offset_x >> 4)) << 8
+                                  | (CMD_SETLOWCOLUMN  + (offset_x & 0x0F)) << 16
+                                  , 24) && --retry)
+        {
+          _bus->endTransaction();
+          _bus->beginTransaction();
+        }
+        if (!retry) { break; }
 
-      auto buf = &_buf[xs + ys * _cfg.panel_width];
-      _bus->writeBytes(buf, xe - xs + 1, true, true);
-    } while (++ys <= ye);
+        auto buf = &_buf[xs + ys * _cfg.panel_width];
+        _bus->writeBytes(buf, xe - xs + 1, true, true);
+      } while (++ys <= ye);
 
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+      _range_mod.pop_back();
+    }
   }
 
 //----------------------------------------------------------------------------
@@ -385,43 +374,39 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int_fast16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int_fast16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int_fast16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int_fast16_t>(_range_mod.bottom, y + h - 1);
+      _add_modified_rect(x, y, x + w - 1, y + h - 1);
     }
-    if (_range_mod.empty()) { return; }
-
-    // xeの位置を2ライン単位の位置にしないと次の描画位置がずれる事があったため調整
-    uint_fast8_t xs = _range_mod.left     ;
-    uint_fast8_t xe = (_range_mod.right+2) & ~1;
-    uint_fast8_t ys = _range_mod.top    >> 3;
-    uint_fast8_t ye = _range_mod.bottom >> 3;
-
     uint_fast8_t offset_y = _cfg.offset_y >> 3;
-    uint_fast8_t offset_x = _cfg.offset_x + xs;
 
-    int retry = 3;
-    do
+    while (!_range_mod.empty())
     {
-      while (!_bus->writeCommand(  CMD_SETPAGEADDR | (ys + offset_y)
-                                | (CMD_SETHIGHCOLUMN + (offset_x >> 4)) << 8
-                                | (CMD_SETLOWCOLUMN  + (offset_x & 0x0F)) << 16
-                                , 24) && --retry)
+      auto& r = _range_mod.back();
+      // xeの位置を2ライン単位の位置にしないと次の描画位置がずれる事があったため調整
+      uint_fast8_t xs = r.left     ;
+      uint_fast8_t xe = (r.right+2) & ~1;
+      uint_fast8_t ys = r.top    >> 3;
+      uint_fast8_t ye = r.bottom >> 3;
+      uint_fast8_t offset_x = _cfg.offset_x + xs;
+
+      int retry = 3;
+      do
       {
-        _bus->endTransaction();
-        _bus->beginTransaction();
-      }
-      if (!retry) { break; }
+        while (!_bus->writeCommand(  CMD_SETPAGEADDR | (ys + offset_y)
+                                  | (CMD_SETHIGHCOLUMN + (offset_x >> 4)) << 8
+                                  | (CMD_SETLOWCOLUMN  + (offset_x & 0x0F)) << 16
+                                  , 24) && --retry)
+        {
+          _bus->endTransaction();
+          _bus->beginTransaction();
+        }
+        if (!retry) { break; }
 
-      auto buf = &_buf[xs + ys * _cfg.panel_width];
-      _bus->writeBytes(buf, xe - xs, true, true);
-    } while (++ys <= ye);
+        auto buf = &_buf[xs + ys * _cfg.panel_width];
+        _bus->writeBytes(buf, xe - xs, true, true);
+      } while (++ys <= ye);
 
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+      _range_mod.pop_back();
+    }
   }
 
 //----------------------------------------------------------------------------
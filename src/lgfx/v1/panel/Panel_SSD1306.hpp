@@ -68,6 +68,11 @@ namespace lgfx
     void _draw_pixel(uint_fast16_t x, uint_fast16_t y, uint32_t value);
     virtual void _update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye);
 
+    // 転送はページ(8ライン)単位で行うため、ページ境界に揃えて更新範囲へ追加する
+    void _add_modified_rect(int_fast16_t xs, int_fast16_t ys, int_fast16_t xe, int_fast16_t ye)
+    {
+      _range_mod.add(xs, ys & ~7, xe, ye | 7);
+    }
   };
 
   struct Panel_SSD1306 : public Panel_1bitOLED
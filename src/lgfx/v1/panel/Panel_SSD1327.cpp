@@ -238,10 +238,8 @@ namespace lgfx
   void Panel_SSD1327::_update_transferred_rect(uint_fast16_t &xs, uint_fast16_t &ys, uint_fast16_t &xe, uint_fast16_t &ye)
   {
     _rotate_pos(xs, ys, xe, ye);
-    _range_mod.left   = std::min<int32_t>(xs, _range_mod.left);
-    _range_mod.right  = std::max<int32_t>(xe, _range_mod.right);
-    _range_mod.top    = std::min<int32_t>(ys, _range_mod.top);
-    _range_mod.bottom = std::max<int32_t>(ye, _range_mod.bottom);
+    // 1バイトに2ピクセルを持つため、X方向は2ピクセル単位に揃える
+    _range_mod.add(xs & ~1, ys, xe | 1, ye);
   }
 
   void Panel_SSD1327::setBrightness(uint8_t brightness)
@@ -262,36 +260,33 @@ namespace lgfx
   {
     if (0 < w && 0 < h)
     {
-      _range_mod.left   = std::min<int16_t>(_range_mod.left  , x        );
-      _range_mod.right  = std::max<int16_t>(_range_mod.right , x + w - 1);
-      _range_mod.top    = std::min<int16_t>(_range_mod.top   , y        );
-      _range_mod.bottom = std::max<int16_t>(_range_mod.bottom, y + h - 1);
+      _range_mod.add(x & ~1, y, (x + w - 1) | 1, y + h - 1);
     }
 
-    if (_range_mod.empty()) { return; }
+    uint_fast8_t ofs_x = _cfg.offset_x >> 1;
+    uint_fast8_t ofs_y = _cfg.offset_y;
+    size_t line_len = (_cfg.panel_width + 1) >> 1;
 
-    uint_fast8_t xs = _range_mod.left  >> 1;
-    uint_fast8_t xe = _range_mod.right >> 1;
-    uint_fast8_t ofs = _cfg.offset_x >> 1;
-
-    _bus->writeCommand(CMD_CASET | (xs + ofs) << 8 | (xe + ofs) << 16, 24);
-
-    uint_fast8_t ys = _range_mod.top    + _cfg.offset_y;
-    uint_fast8_t ye = _range_mod.bottom + _cfg.offset_y;
-    ofs = _cfg.offset_y;
-    _bus->writeCommand(CMD_RASET | (ys + ofs) << 8 | (ye + ofs) << 16, 24);
-
-    w = xe - xs + 1;
-    do
+    // 更新矩形ごとにアドレス範囲を指定して転送する
+    while (!_range_mod.empty())
     {
-      auto buf = &_buf[xs + ys * ((_cfg.panel_width + 1) >> 1 )]; 
-      _bus->writeBytes(buf, w, true, true);
-    } while (++ys <= ye);
-
-    _range_mod.top    = INT16_MAX;
-    _range_mod.left   = INT16_MAX;
-    _range_mod.right  = 0;
-    _range_mod.bottom = 0;
+      auto& r = _range_mod.back();
+      uint_fast8_t xs = r.left  >> 1;
+      uint_fast8_t xe = r.right >> 1;
+      uint_fast8_t ys = r.top;
+      uint_fast8_t ye = r.bottom;
+      _bus->writeCommand(CMD_CASET | (xs + ofs_x) << 8 | (xe + ofs_x) << 16, 24);
+      _bus->writeCommand(CMD_RASET | (ys + ofs_y) << 8 | (ye + ofs_y) << 16, 24);
+
+      w = xe - xs + 1;
+      do
+      {
+        auto buf = &_buf[xs + ys * line_len];
+        _bus->writeBytes(buf, w, true, true);
+      } while (++ys <= ye);
+
+      _range_mod.pop_back();
+    }
   }
 
 
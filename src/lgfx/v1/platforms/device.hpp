@@ -103,3 +103,9 @@ Contributors:
 
 #endif
 
+#if defined ( __linux__ ) || defined ( __APPLE__ ) || defined ( _WIN32 )
+
+#include "../panel/Panel_Headless.hpp"
+
+#endif
+
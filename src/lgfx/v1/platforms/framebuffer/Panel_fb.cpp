@@ -24,6 +24,8 @@ Porting for Linux FrameBuffer:
 
 #include "../common.hpp"
 #include "../../Bus.hpp"
+#include "../../misc/pixelcopy.hpp"
+#include "../../misc/common_function.hpp"
 
 #include <list>
 #include <dirent.h>
@@ -36,59 +38,158 @@ namespace lgfx
  inline namespace v1
  {
 //----------------------------------------------------------------------------
-  void Panel_fb::fb_draw_rgb_pixel(int x, int y, uint32_t rawcolor)
+  // 描画は rgb565_2Byte / rgb888_3Byte で行い、フレームバッファへの読み書きの際に画素形式を変換する。
+  // RGB565 (little endian) / BGR888 / BGRX8888
+  static void raw_to_fb(uint8_t* __restrict dst, const uint8_t* __restrict src, size_t len, size_t fb_bytes)
   {
-    unsigned int pix_offset = 0;
-    uint8_t r = 0, g = 0, b = 0;
+    switch (fb_bytes)
+    {
+    case 2:
+      for (size_t i = 0; i < len; ++i)
+      {
+        dst[0] = src[1];
+        dst[1] = src[0];
+        dst += 2;
+        src += 2;
+      }
+      break;
+
+    case 3:
+      for (size_t i = 0; i < len; ++i)
+      {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst += 3;
+        src += 3;
+      }
+      break;
+
+    case 4:
+      for (size_t i = 0; i < len; ++i)
+      {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = 0xFF;
+        dst += 4;
+        src += 3;
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  static void fb_to_raw(uint8_t* __restrict dst, const uint8_t* __restrict src, size_t len, size_t fb_bytes)
+  {
+    if (fb_bytes == 2)
+    {
+      for (size_t i = 0; i < len; ++i)
+      {
+        dst[0] = src[1];
+        dst[1] = src[0];
+        dst += 2;
+        src += 2;
+      }
+    }
+    else
+    {
+      for (size_t i = 0; i < len; ++i)
+      {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst += 3;
+        src += fb_bytes;
+      }
+    }
+  }
+
+  uint32_t Panel_fb::_fb_color(uint32_t rawcolor) const
+  {
+    return (_fb_bytes == 2) ? getSwap16(rawcolor)
+         : (_fb_bytes == 3) ? getSwap24(rawcolor)
+                            : getSwap24(rawcolor) | 0xFF000000u;
+  }
 
-    // GGGBBBBB RRRRRGGG
-    if (_write_depth = color_depth_t::rgb565_2Byte)
+  // 論理座標 (x,y) の画素のアドレスと、x方向に1画素進む際のアドレスの増分を求める
+  uint8_t* Panel_fb::_get_span_ptr(uint_fast16_t x, uint_fast16_t y, int32_t* step) const
+  {
+    int32_t bytes = _fb_bytes;
+    int32_t stride = _fix_info.line_length;
+    int32_t add = bytes;
+    uint_fast8_t r = _internal_rotation;
+    if (r)
     {
-      b = (uint8_t)((rawcolor >> 8) & 0b11111);
-      g = (uint8_t)((((rawcolor >> 10) & 0b111000)) | (rawcolor & 0b111));
-      r = (uint8_t)((rawcolor >> 3) & 0b11111);
-
-      pix_offset = x * 2 + y * _fix_info.line_length;
-      unsigned short c = (r << 11) | (g << 5) | b;
-      // write 'two bytes at once'
-      *((unsigned short*)(_fbp + pix_offset)) = c;
+      if ((1u << r) & 0b10010110) { y = _height - (y + 1); }
+      if (r & 2)                  { x = _width  - (x + 1); add = -add; }
+      if (r & 1)
+      {
+        std::swap(x, y);
+        add = (add < 0) ? -stride : stride;
+      }
     }
-    // BBBBBBBB GGGGGGGG RRRRRRRR
-    else if (_write_depth = color_depth_t::rgb888_3Byte)
+    *step = add;
+    return (uint8_t*)&_fbp[y * stride + x * bytes];
+  }
+
+  void Panel_fb::_store_span(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len, const uint8_t* raw)
+  {
+    int32_t step;
+    auto dst = _get_span_ptr(x, y, &step);
+    size_t fb_bytes = _fb_bytes;
+    if (step == (int32_t)fb_bytes)
     {
-      b = (uint8_t)((rawcolor >> 16) & 0xff);
-      g = (uint8_t)((rawcolor >> 8) & 0xff);
-      r = (uint8_t)((rawcolor >> 0) & 0xff);
-
-      pix_offset = x * 3 + y * _fix_info.line_length;
-      *((char*)(_fbp + pix_offset)) = b;
-      *((char*)(_fbp + pix_offset + 1)) = g;
-      *((char*)(_fbp + pix_offset + 2)) = r;
+      raw_to_fb(dst, raw, len, fb_bytes);
+      return;
     }
+    size_t raw_bytes = _write_bits >> 3;
+    do
+    {
+      raw_to_fb(dst, raw, 1, fb_bytes);
+      dst += step;
+      raw += raw_bytes;
+    } while (--len);
   }
 
-  void Panel_fb::fb_draw_argb_pixel(int x, int y, uint32_t rawcolor)
+  void Panel_fb::_load_span(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len, uint8_t* raw) const
   {
-    unsigned int pix_offset = x * 4 + y * _fix_info.line_length;
-
-    uint8_t r = 0, g = 0, b = 0, a = 0;
-
-    // BBBBBBBB GGGGGGGG RRRRRRRR AAAAAAAA
-    b = (uint8_t)((rawcolor >> 24) & 0xff);
-    g = (uint8_t)((rawcolor >> 16) & 0xff);
-    r = (uint8_t)((rawcolor >> 8) & 0xff);
-    a = (uint8_t)((rawcolor >> 0) & 0xff);
-    
-    *((char*)(_fbp + pix_offset)) = b;
-    *((char*)(_fbp + pix_offset + 1)) = g;
-    *((char*)(_fbp + pix_offset + 2)) = r;
-    *((char*)(_fbp + pix_offset + 3)) = a;
+    int32_t step;
+    auto src = _get_span_ptr(x, y, &step);
+    size_t fb_bytes = _fb_bytes;
+    if (step == (int32_t)fb_bytes)
+    {
+      fb_to_raw(raw, src, len, fb_bytes);
+      return;
+    }
+    size_t raw_bytes = _read_bits >> 3;
+    do
+    {
+      fb_to_raw(raw, src, 1, fb_bytes);
+      src += step;
+      raw += raw_bytes;
+    } while (--len);
   }
 
   Panel_fb::~Panel_fb(void)
   {
+    if (_page_flip && _front_page)
+    {
+      _var_info.yoffset = 0;
+      ioctl(_fbfd, FBIOPAN_DISPLAY, &_var_info);
+    }
+    if (_shadow)
+    {
+      heap_free(_shadow);
+    }
+    if (_line_buffer)
+    {
+      heap_free(_line_buffer);
+    }
     // unmap fb file from memory
-    munmap(_fbp, _screensize);
+    munmap(_fb_map, _screensize);
     // close fb file    
     close(_fbfd);
 
@@ -143,6 +244,18 @@ namespace lgfx
     }
     // printf("%dx%d, %dbpp\n", _var_info.xres, _var_info.yres, _var_info.bits_per_pixel);
 
+    // ページフリップ用に仮想画面の高さを2倍にする。失敗した場合はRAM上のバックバッファを使う。
+    if (_config_detail.use_back_buffer && _var_info.yres_virtual < _var_info.yres * 2)
+    {
+      auto vinfo = _var_info;
+      vinfo.yres_virtual = vinfo.yres * 2;
+      vinfo.yoffset = 0;
+      if (0 == ioctl(_fbfd, FBIOPUT_VSCREENINFO, &vinfo))
+      {
+        ioctl(_fbfd, FBIOGET_VSCREENINFO, &_var_info);
+      }
+    }
+
     // 16/24/32
     setColorDepth((color_depth_t)_var_info.bits_per_pixel);
 
@@ -156,26 +269,130 @@ namespace lgfx
     _screensize = _fix_info.smem_len;  //finfo.line_length * vinfo.yres;    
 
     // Map the device to memory
-    _fbp = (char *)mmap(0, _screensize, PROT_READ | PROT_WRITE, MAP_SHARED, _fbfd, 0);
-    if((intptr_t)_fbp == -1) {
+    _fb_map = (char *)mmap(0, _screensize, PROT_READ | PROT_WRITE, MAP_SHARED, _fbfd, 0);
+    if((intptr_t)_fb_map == -1) {
+        _fb_map = nullptr;
         perror("Error: failed to map framebuffer device to memory");
         return false;
     }
-    memset(_fbp, 0, _screensize);
+    memset(_fb_map, 0, _screensize);
+    _fbp = _fb_map;
+
+    if (_line_buffer == nullptr)
+    {
+      _line_buffer = (uint8_t*)heap_alloc(std::max(_cfg.panel_width, _cfg.panel_height) * 3);
+      if (_line_buffer == nullptr) { return false; }
+    }
+
+    if (_config_detail.use_back_buffer)
+    {
+      _init_back_buffer();
+    }
 
     return Panel_Device::init(use_reset);
   }
 
+  void Panel_fb::_init_back_buffer(void)
+  {
+    _page_size = _fix_info.line_length * _var_info.yres;
+    _page_flip = _fix_info.ypanstep
+              && _var_info.yres_virtual >= _var_info.yres * 2
+              && (uint32_t)_screensize >= _page_size * 2;
+    if (_page_flip)
+    {
+      _var_info.yoffset = 0;
+      _page_flip = (0 == ioctl(_fbfd, FBIOPAN_DISPLAY, &_var_info));
+    }
+    if (_page_flip)
+    {
+      _front_page = 0;
+      _fbp = _fb_map + _page_size;
+    }
+    else
+    {
+      _shadow = (char*)heap_alloc(_page_size);
+      if (_shadow)
+      {
+        memset(_shadow, 0, _page_size);
+        _fbp = _shadow;
+      }
+    }
+    _double_buffered = _page_flip || _shadow;
+    _wait_vsync = _config_detail.wait_vsync;
+    _dirty_rects.clear();
+  }
+
+  void Panel_fb::_add_dirty_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    if (!_double_buffered) { return; }
+
+    uint_fast8_t r = _internal_rotation;
+    if (r)
+    {
+      if ((1u << r) & 0b10010110) { y = _height - (y + h); }
+      if (r & 2)                  { x = _width  - (x + w); }
+      if (r & 1) { std::swap(x, y);  std::swap(w, h); }
+    }
+    _dirty_rects.add(x, y, x + w - 1, y + h - 1);
+  }
+
   void Panel_fb::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
   {
-    // Nothings to do
+    (void)x;
+    (void)y;
+    (void)w;
+    (void)h;
+    // バックバッファ未使用時は常に画面へ直接描画されている
+    if (!_double_buffered || _dirty_rects.empty()) { return; }
+
+    if (_wait_vsync)
+    {
+      uint32_t arg = 0;
+      if (ioctl(_fbfd, FBIO_WAITFORVSYNC, &arg))
+      { // not supported by this driver.
+        _wait_vsync = false;
+      }
+    }
+
+    // シャドウバッファ時は変更箇所を画面へコピーする。
+    // ページフリップ時は表示を切替えた後、変更箇所を旧表示ページへコピーして次の描画先とする。
+    const char* src = _fbp;
+    char* dst = _fb_map + (_front_page * _page_size);
+    if (_page_flip)
+    {
+      _var_info.yoffset = (_front_page ^ 1) * _var_info.yres;
+      if (0 == ioctl(_fbfd, FBIOPAN_DISPLAY, &_var_info))
+      {
+        _front_page ^= 1;
+        _fbp = dst;
+      }
+    }
+
+    size_t bytes = _fb_bytes;
+    size_t stride = _fix_info.line_length;
+    for (size_t i = 0; i < _dirty_rects.count; ++i)
+    {
+      auto& r = _dirty_rects.rects[i];
+      int_fast16_t right  = std::min<int_fast16_t>(r.right , _var_info.xres - 1);
+      int_fast16_t bottom = std::min<int_fast16_t>(r.bottom, _var_info.yres - 1);
+      if (right < r.left || bottom < r.top) { continue; }
+      size_t len = (right - r.left + 1) * bytes;
+      size_t offset = r.top * stride + r.left * bytes;
+      for (int_fast16_t y = r.top; y <= bottom; ++y)
+      {
+        memcpy(&dst[offset], &src[offset], len);
+        offset += stride;
+      }
+    }
+    _dirty_rects.clear();
   }
 
   color_depth_t Panel_fb::setColorDepth(color_depth_t depth)
   {
-    // TODO
-    _write_bits = depth;
-    _read_bits = depth;
+    // フレームバッファの画素形式は変更できないため、それに合わせた描画形式を選ぶ
+    uint_fast8_t bits = _var_info.bits_per_pixel ? _var_info.bits_per_pixel : (depth & color_depth_t::bit_mask);
+    _fb_bytes = (bits > 24) ? 4 : (bits > 16) ? 3 : 2;
+    depth = (_fb_bytes == 2) ? rgb565_2Byte : rgb888_3Byte;
     _write_depth = depth;
     _read_depth = depth;
     return depth;
@@ -212,63 +429,36 @@ namespace lgfx
 
   void Panel_fb::drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor)
   {
-    uint_fast8_t rotation = _internal_rotation;
-    if (rotation)
-    {
-      if ((1u << rotation) & 0b10010110) { y = _height - (y + 1); }
-      if (rotation & 2)                  { x = _width  - (x + 1); }
-      if (rotation & 1) { std::swap(x, y); }
-    }
-
-    switch (_write_depth)
-    {
-      case color_depth_t::rgb565_2Byte:
-      case color_depth_t::rgb888_3Byte:
-        fb_draw_rgb_pixel(x, y, rawcolor);
-        break;
-      case color_depth_t::argb8888_4Byte:
-        fb_draw_argb_pixel(x, y, rawcolor);
-        break;
-      default:
-        break;
-    }
+    _add_dirty_rect(x, y, 1, 1);
 
-    if (!getStartCount())
-    {
-      display(x, y, 1, 1);
-    }
+    int32_t step;
+    auto dst = _get_span_ptr(x, y, &step);
+    uint32_t color = _fb_color(rawcolor);
+    memcpy(dst, &color, _fb_bytes);
   }
 
   void Panel_fb::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
   {
-    uint_fast8_t rotation = _internal_rotation;
-    if (rotation)
+    _add_dirty_rect(x, y, w, h);
+
+    uint_fast8_t r = _internal_rotation;
+    if (r)
     {
-      if ((1u << rotation) & 0b10010110) { y = _height - (y + 1); }
-      if (rotation & 2)                  { x = _width  - (x + 1); }
-      if (rotation & 1) { std::swap(x, y); }
+      if ((1u << r) & 0b10010110) { y = _height - (y + h); }
+      if (r & 2)                  { x = _width  - (x + w); }
+      if (r & 1) { std::swap(x, y);  std::swap(w, h); }
     }
 
-    for (size_t width = 0; width < w; width++)
+    size_t bytes = _fb_bytes;
+    size_t stride = _fix_info.line_length;
+    size_t len = w * bytes;
+    auto dst = (uint8_t*)&_fbp[y * stride + x * bytes];
+    memset_multi(dst, _fb_color(rawcolor), bytes, w);
+    // 1行目を複製して残りの行を埋める
+    for (auto src = dst; --h; )
     {
-      for (size_t height = 0; height < h; height++)
-      {
-        uint_fast16_t x_pos = x + width;
-        uint_fast16_t y_pos = y + height;
-
-        switch (_write_depth)
-        {
-          case color_depth_t::rgb565_2Byte:
-          case color_depth_t::rgb888_3Byte:
-            fb_draw_rgb_pixel(x_pos, y_pos, rawcolor);
-            break;
-          case color_depth_t::argb8888_4Byte:
-            fb_draw_argb_pixel(x_pos, y_pos, rawcolor);
-            break;
-          default:
-            break;
-        }
-      }
+      dst += stride;
+      memcpy(dst, src, len);
     }
   }
 
@@ -290,225 +480,118 @@ namespace lgfx
     } while (length);
   }
 
-  void Panel_fb::_rotate_pixelcopy(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h, pixelcopy_t* param, uint32_t& nextx, uint32_t& nexty)
-  {
-    // NOT TEST
-    uint32_t addx = param->src_x32_add;
-    uint32_t addy = param->src_y32_add;
-    uint_fast8_t r = _internal_rotation;
-    uint_fast8_t bitr = 1u << r;
-    if (bitr & 0b10010110) // case 1:2:4:7:
-    {
-      param->src_y32 += nexty * (h - 1);
-      nexty = -(int32_t)nexty;
-      y = _height - (y + h);
-    }
-    if (r & 2)
-    {
-      param->src_x32 += addx * (w - 1);
-      param->src_y32 += addy * (w - 1);
-      addx = -(int32_t)addx;
-      addy = -(int32_t)addy;
-      x = _width  - (x + w);
-    }
-    if (r & 1)
-    {
-      std::swap(x, y);
-      std::swap(w, h);
-      std::swap(nextx, addx);
-      std::swap(nexty, addy);
-    }
-    param->src_x32_add = addx;
-    param->src_y32_add = addy;
-  }
-
   void Panel_fb::writePixels(pixelcopy_t* param, uint32_t length, bool use_dma)
   {
-    // NOT TEST
-    uint_fast16_t xs = _xs;
-    uint_fast16_t xe = _xe;
-    uint_fast16_t ys = _ys;
-    uint_fast16_t ye = _ye;
+    (void)use_dma;
+    _add_dirty_rect(_xs, _ys, _xe - _xs + 1, _ye - _ys + 1);
+
+    auto buf = _line_buffer;
     uint_fast16_t x = _xpos;
     uint_fast16_t y = _ypos;
-    const size_t bits = _write_bits;
-    auto k = _cfg.panel_width * bits >> 3;
-
-    uint_fast8_t r = _internal_rotation;
-    if (!r)
-    {
-      uint_fast16_t linelength;
-      do {
-        linelength = std::min<uint_fast16_t>(xe - x + 1, length);
-        param->fp_copy(&_fbp[y * k], x, x + linelength, param);
-        if ((x += linelength) > xe)
-        {
-          x = xs;
-          y = (y != ye) ? (y + 1) : ys;
-        }
-      } while (length -= linelength);
-      _xpos = x;
-      _ypos = y;
-      return;
-    }
-
-    int_fast16_t ax = 1;
-    int_fast16_t ay = 1;
-    if ((1u << r) & 0b10010110) { y = _height - (y + 1); ys = _height - (ys + 1); ye = _height - (ye + 1); ay = -1; }
-    if (r & 2)                  { x = _width  - (x + 1); xs = _width  - (xs + 1); xe = _width  - (xe + 1); ax = -1; }
-    if (param->no_convert)
-    {
-      size_t bytes = bits >> 3;
-      size_t xw = 1;
-      size_t yw = _cfg.panel_width;
-      if (r & 1) std::swap(xw, yw);
-      size_t idx = y * yw + x * xw;
-      auto data = (uint8_t*)param->src_data;
-      do
-      {
-        auto dst = &_fbp[idx * bytes];
-        size_t b = 0;
-        do
-        {
-          dst[b] = *data++;
-        } while (++b < bytes);
-        if (x != xe)
-        {
-          idx += xw * ax;
-          x += ax;
-        }
-        else
-        {
-          x = xs;
-          y = (y != ye) ? (y + ay) : ys;
-          idx = y * yw + x * xw;
-        }
-      } while (--length);
-    }
-    else
+    uint32_t len;
+    do
     {
-      if (r & 1)
-      {
-        do
-        {
-          param->fp_copy(&_fbp[x * k], y, y + 1, param);
-          if (x != xe)
-          {
-            x += ax;
-          }
-          else
-          {
-            x = xs;
-            y = (y != ye) ? (y + ay) : ys;
-          }
-        } while (--length);
-      }
-      else
+      len = std::min<uint32_t>(_xe - x + 1, length);
+      param->fp_copy(buf, 0, len, param);
+      _store_span(x, y, len, buf);
+      if ((x += len) > _xe)
       {
-        do
-        {
-          param->fp_copy(&_fbp[y * k], x, x + 1, param);
-          if (x != xe)
-          {
-            x += ax;
-          }
-          else
-          {
-            x = xs;
-            y = (y != ye) ? (y + ay) : ys;
-          }
-        } while (--length);
+        x = _xs;
+        y = (y != _ye) ? (y + 1) : _ys;
       }
-    }
-    if ((1u << r) & 0b10010110) { y = _height - (y + 1); }
-    if (r & 2)                  { x = _width  - (x + 1); }
+    } while (length -= len);
     _xpos = x;
     _ypos = y;
   }
 
   void Panel_fb::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool)
   {
-    // NOT TEST
-    uint_fast8_t r = _internal_rotation;
-    if (r == 0 && param->transp == pixelcopy_t::NON_TRANSP && param->no_convert)
-    {
-      auto sx = param->src_x;
-      auto bits = param->src_bits;
-
-      auto bw = _cfg.panel_width * bits >> 3;
-      auto dst = &_fbp[bw * y];
-      auto sw = param->src_bitwidth * bits >> 3;
-      auto src = &((uint8_t*)param->src_data)[param->src_y * sw];
-      if (sw == bw && this->_cfg.panel_width == w && sx == 0 && x == 0)
-      {
-        memcpy(dst, src, bw * h);
-        return;
-      }
-      y = 0;
-      dst +=  x * bits >> 3;
-      src += sx * bits >> 3;
-      w    =  w * bits >> 3;
+    _add_dirty_rect(x, y, w, h);
+
+    h += y;
+    if (param->transp == pixelcopy_t::NON_TRANSP && param->no_convert)
+    { // 変換不要な場合は元データから直接書込む
+      auto bytes = _write_bits >> 3;
+      auto sw = param->src_bitwidth * bytes;
+      auto src = &((const uint8_t*)param->src_data)[param->src_y * sw + param->src_x * bytes];
       do
       {
-        memcpy(&dst[y * bw], &src[y * sw], w);
+        _store_span(x, y, w, src);
+        src += sw;
       } while (++y != h);
       return;
     }
 
-    uint32_t nextx = 0;
-    uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
-    if (r)
-    {
-      _rotate_pixelcopy(x, y, w, h, param, nextx, nexty);
-    }
+    auto buf = _line_buffer;
+    bool transp = (param->transp != pixelcopy_t::NON_TRANSP);
     uint32_t sx32 = param->src_x32;
     uint32_t sy32 = param->src_y32;
-
-    y *= _cfg.panel_width;
     do
     {
-      int32_t pos = x + y;
-      int32_t end = pos + w;
-      while (end != (pos = param->fp_copy(_fbp, pos, end, param))
-         &&  end != (pos = param->fp_skip(      pos, end, param)));
-      param->src_x32 = (sx32 += nextx);
-      param->src_y32 = (sy32 += nexty);
-      y += _cfg.panel_width;
-    } while (--h);
+      if (transp)
+      { // 透過色の画素は描画済みの内容を残す
+        _load_span(x, y, w, buf);
+        int32_t pos = 0;
+        int32_t end = w;
+        while (end != (pos = param->fp_copy(buf, pos, end, param))
+           &&  end != (pos = param->fp_skip(     pos, end, param)));
+      }
+      else
+      {
+        param->fp_copy(buf, 0, w, param);
+      }
+      _store_span(x, y, w, buf);
+      param->src_x32 = sx32;
+      param->src_y32 = (sy32 += 1 << pixelcopy_t::FP_SCALE);
+    } while (++y != h);
   }
 
   void Panel_fb::writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param)
   {
-    // NOT TEST
-    uint32_t nextx = 0;
-    uint32_t nexty = 1 << pixelcopy_t::FP_SCALE;
-    if (_internal_rotation)
-    {
-      _rotate_pixelcopy(x, y, w, h, param, nextx, nexty);
-    }
+    _add_dirty_rect(x, y, w, h);
+
+    auto buf = _line_buffer;
     uint32_t sx32 = param->src_x32;
     uint32_t sy32 = param->src_y32;
-
-    uint32_t pos = x + y * _cfg.panel_width;
-    uint32_t end = pos + w;
-    param->fp_copy(_fbp, pos, end, param);
-    while (--h)
+    h += y;
+    do
     {
-      pos += _cfg.panel_width;
-      end = pos + w;
-      param->src_x32 = (sx32 += nextx);
-      param->src_y32 = (sy32 += nexty);
-      param->fp_copy(_fbp, pos, end, param);
-    }
+      _load_span(x, y, w, buf);
+      param->fp_copy(buf, 0, w, param);
+      _store_span(x, y, w, buf);
+      param->src_x32 = sx32;
+      param->src_y32 = (sy32 += 1 << pixelcopy_t::FP_SCALE);
+    } while (++y != h);
   }
 
   void Panel_fb::readRect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, void* dst, pixelcopy_t* param)
   {
-    // TODO
+    auto buf = _line_buffer;
+    auto d = (uint8_t*)dst;
+    size_t bytes = _read_bits >> 3;
+    uint32_t pos = 0;
+    h += y;
+    do
+    {
+      if (param->no_convert)
+      {
+        _load_span(x, y, w, &d[pos * bytes]);
+      }
+      else
+      {
+        _load_span(x, y, w, buf);
+        param->src_data = buf;
+        param->src_x32 = 0;
+        param->src_y32 = 0;
+        param->fp_copy(dst, pos, pos + w, param);
+      }
+      pos += w;
+    } while (++y != h);
   }
 
   void Panel_fb::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
   {
+    _add_dirty_rect(dst_x, dst_y, w, h);
 
     uint_fast8_t r = _internal_rotation;
     if (r)
@@ -518,13 +601,17 @@ namespace lgfx
       if (r & 1) { std::swap(src_x, src_y);  std::swap(dst_x, dst_y);  std::swap(w, h); }
     }
 
-    if ((dst_x + w) > _var_info.xres) w = _var_info.xres - dst_x;
-    if ((dst_y + h) > _var_info.yres) h = _var_info.yres - dst_y;
-    size_t bytes = _write_bits >> 3;
+    size_t bytes = _fb_bytes;
     size_t len = w * bytes;
-    int32_t add = _var_info.xres * bytes;  // _cfg.panel_width may not was the screen width, use _var_info.xres instead.
-    char *src = (_fbp + (src_x * bytes + src_y * _fix_info.line_length));
-    char *dst = (_fbp + (dst_x * bytes + dst_y * _fix_info.line_length));
+    int32_t add = _fix_info.line_length;
+    char *src = (_fbp + (src_x * bytes + src_y * add));
+    char *dst = (_fbp + (dst_x * bytes + dst_y * add));
+    if (dst_y > src_y)
+    { // 下方向へ移動する場合は下の行からコピーする
+      src += add * (h - 1);
+      dst += add * (h - 1);
+      add = -add;
+    }
 
     do
     {
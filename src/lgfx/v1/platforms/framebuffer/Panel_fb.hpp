@@ -47,6 +47,16 @@ namespace lgfx
     {
       // 操作対象とするフレームバッファのパス名、または、デバイス名称 ("st7789") 等の文字列へのポインタを指定する。
       const char* device_name = "/dev/fb0";
+
+      // バックバッファに描画し、display() の呼出し時に画面へ反映する。
+      // ドライバが対応していれば yres_virtual を2倍にしてページフリップを行い、非対応ならRAM上のバッファから変更箇所をコピーする。
+      /// Draw into a back buffer and show it when display() is called.
+      /// Uses page flipping (doubled yres_virtual) when the driver allows it, otherwise copies the changed areas from a RAM buffer.
+      bool use_back_buffer = false;
+
+      // display() の際に垂直同期を待つ (FBIO_WAITFORVSYNC 対応ドライバのみ)
+      /// Wait for vsync in display(). (only drivers supporting FBIO_WAITFORVSYNC)
+      bool wait_vsync = true;
     };
 
     bool init(bool use_reset) override;
@@ -91,19 +101,34 @@ namespace lgfx
     touch_point_t _touch_point;
     // framebuffer
     int _fbfd = 0;
-    char* _fbp = 0;
+    char* _fbp = 0;           // 描画先 / drawing target
+    char* _fb_map = nullptr;  // mmap された先頭 / start of the mapped device memory
     long int _screensize = 0;
+
+    // back buffer
+    char* _shadow = nullptr;
+    uint32_t _page_size = 0;
+    uint_fast8_t _front_page = 0;
+    bool _page_flip = false;
+    bool _double_buffered = false; // 描画先が表示中の画面と別 / drawing target is not the visible page
+    bool _wait_vsync = false;
+    range_rect_list_t<16> _dirty_rects; // panel coordinates
     struct fb_var_screeninfo _var_info;
     struct fb_fix_screeninfo _fix_info;
 
     int32_t _xpos = 0;
     int32_t _ypos = 0;
 
-    void _rotate_pixelcopy(uint_fast16_t& x, uint_fast16_t& y, uint_fast16_t& w, uint_fast16_t& h, pixelcopy_t* param, uint32_t& nextx, uint32_t& nexty);
+    uint8_t* _line_buffer = nullptr;  // 1ライン分の変換用バッファ / one line of raw pixels
+    uint_fast8_t _fb_bytes = 2;       // フレームバッファの1画素のバイト数 / bytes per pixel of the device
+
+    void _init_back_buffer(void);
+    void _add_dirty_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h);
 
-  private:
-    void fb_draw_rgb_pixel(int x, int y, uint32_t rawcolor);
-    void fb_draw_argb_pixel(int x, int y, uint32_t rawcolor);
+    uint32_t _fb_color(uint32_t rawcolor) const;
+    uint8_t* _get_span_ptr(uint_fast16_t x, uint_fast16_t y, int32_t* step) const;
+    void _store_span(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len, const uint8_t* raw);
+    void _load_span(uint_fast16_t x, uint_fast16_t y, uint_fast16_t len, uint8_t* raw) const;
   };
 
 //----------------------------------------------------------------------------
@@ -376,9 +376,33 @@ namespace lgfx
     _write_depth = depth;
     _read_depth = depth;
 
+    // the raw data is read in a different format from now on.
+    _add_dirty_all();
+
     return depth;
   }
 
+  void Panel_sdl::_add_dirty_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
+  {
+    uint_fast8_t r = _internal_rotation;
+    if (r)
+    {
+      if ((1u << r) & 0b10010110) { y = _height - (y + h); }
+      if (r & 2)                  { x = _width  - (x + w); }
+      if (r & 1) { std::swap(x, y);  std::swap(w, h); }
+    }
+    _dirty_rects.add(x, y, x + w - 1, y + h - 1);
+  }
+
+  void Panel_sdl::_add_dirty_all(void)
+  {
+    SDL_LockMutex(_sdl_mutex);
+    _dirty_rects.clear();
+    _dirty_rects.add(0, 0, _cfg.panel_width - 1, _cfg.panel_height - 1);
+    ++_modified_counter;
+    SDL_UnlockMutex(_sdl_mutex);
+  }
+
   Panel_sdl::lock_t::lock_t(Panel_sdl* parent)
   : _parent { parent }
   {
@@ -402,36 +426,67 @@ namespace lgfx
   {
     lock_t lock(this);
     Panel_FrameBufferBase::drawPixelPreclipped(x, y, rawcolor);
+    _add_dirty_rect(x, y, 1, 1);
   }
 
   void Panel_sdl::writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor)
   {
     lock_t lock(this);
     Panel_FrameBufferBase::writeFillRectPreclipped(x, y, w, h, rawcolor);
+    _add_dirty_rect(x, y, w, h);
+  }
+
+  void Panel_sdl::writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t rawcolor)
+  {
+    if (!count) { return; }
+    lock_t lock(this);
+    Panel_FrameBufferBase::writeFillRectsPreclipped(rects, count, rawcolor);
+    uint_fast16_t xs = rects[0].x, ys = rects[0].y;
+    uint_fast16_t xe = xs + rects[0].w, ye = ys + rects[0].h;
+    for (size_t i = 1; i < count; ++i)
+    {
+      auto& r = rects[i];
+      if (xs > r.x) { xs = r.x; }
+      if (ys > r.y) { ys = r.y; }
+      if (xe < (uint_fast16_t)(r.x + r.w)) { xe = r.x + r.w; }
+      if (ye < (uint_fast16_t)(r.y + r.h)) { ye = r.y + r.h; }
+    }
+    _add_dirty_rect(xs, ys, xe - xs, ye - ys);
   }
 
   void Panel_sdl::writeBlock(uint32_t rawcolor, uint32_t length)
   {
-//    lock_t lock(this);
+    lock_t lock(this);
     Panel_FrameBufferBase::writeBlock(rawcolor, length);
+    _add_dirty_rect(_xs, _ys, _xe - _xs + 1, _ye - _ys + 1);
   }
 
   void Panel_sdl::writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma)
   {
     lock_t lock(this);
     Panel_FrameBufferBase::writeImage(x, y, w, h, param, use_dma);
+    _add_dirty_rect(x, y, w, h);
   }
 
   void Panel_sdl::writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param)
   {
     lock_t lock(this);
     Panel_FrameBufferBase::writeImageARGB(x, y, w, h, param);
+    _add_dirty_rect(x, y, w, h);
   }
 
   void Panel_sdl::writePixels(pixelcopy_t* param, uint32_t len, bool use_dma)
   {
     lock_t lock(this);
     Panel_FrameBufferBase::writePixels(param, len, use_dma);
+    _add_dirty_rect(_xs, _ys, _xe - _xs + 1, _ye - _ys + 1);
+  }
+
+  void Panel_sdl::copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y)
+  {
+    lock_t lock(this);
+    Panel_FrameBufferBase::copyRect(dst_x, dst_y, w, h, src_x, src_y);
+    _add_dirty_rect(dst_x, dst_y, w, h);
   }
 
   void Panel_sdl::display(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h)
@@ -539,6 +594,7 @@ namespace lgfx
     if (monitor.renderer == nullptr)
     {
       sdl_create(&monitor);
+      _add_dirty_all();
     }
 
     bool step_exec = _in_step_exec;
@@ -558,14 +614,27 @@ namespace lgfx
       if (0 == SDL_LockMutex(_sdl_mutex))
       {
         _texupdate_counter = _modified_counter;
-        for (int y = 0; y < _cfg.panel_height; ++y)
+        // 変更された範囲のみ変換・転送する
+        auto dirty = _dirty_rects;
+        _dirty_rects.clear();
+        size_t bytes = (_write_bits + 7) >> 3;
+        for (size_t i = 0; i < dirty.count; ++i)
         {
-          pc.src_x32 = 0;
-          pc.src_data = _lines_buffer[y];
-          pc.fp_copy(&_texturebuf[y * _cfg.panel_width], 0, _cfg.panel_width, &pc);
+          auto& r = dirty.rects[i];
+          for (int y = r.top; y <= r.bottom; ++y)
+          {
+            pc.src_x32 = 0;
+            pc.src_data = &_lines_buffer[y][r.left * bytes];
+            pc.fp_copy(&_texturebuf[y * _cfg.panel_width + r.left], 0, r.width(), &pc);
+          }
         }
         SDL_UnlockMutex(_sdl_mutex);
-        SDL_UpdateTexture(monitor.texture, nullptr, _texturebuf, _cfg.panel_width * sizeof(rgb888_t));
+        for (size_t i = 0; i < dirty.count; ++i)
+        {
+          auto& r = dirty.rects[i];
+          SDL_Rect rect = { (int)r.left, (int)r.top, (int)r.width(), (int)r.height() };
+          SDL_UpdateTexture(monitor.texture, &rect, &_texturebuf[r.top * _cfg.panel_width + r.left], _cfg.panel_width * sizeof(rgb888_t));
+        }
       }
     }
 
@@ -83,10 +83,12 @@ namespace lgfx
     // void setInvert(bool invert) override {}
     void drawPixelPreclipped(uint_fast16_t x, uint_fast16_t y, uint32_t rawcolor) override;
     void writeFillRectPreclipped(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, uint32_t rawcolor) override;
+    void writeFillRectsPreclipped(const fill_rect_t* rects, size_t count, uint32_t rawcolor) override;
     void writeBlock(uint32_t rawcolor, uint32_t length) override;
     void writeImage(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param, bool use_dma) override;
     void writeImageARGB(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h, pixelcopy_t* param) override;
     void writePixels(pixelcopy_t* param, uint32_t len, bool use_dma) override;
+    void copyRect(uint_fast16_t dst_x, uint_fast16_t dst_y, uint_fast16_t w, uint_fast16_t h, uint_fast16_t src_x, uint_fast16_t src_y) override;
 
     uint_fast8_t getTouchRaw(touch_point_t* tp, uint_fast8_t count) override;
 
@@ -122,6 +124,7 @@ namespace lgfx
     monitor_t monitor;
 
     rgb888_t* _texturebuf = nullptr;
+    range_rect_list_t<8> _dirty_rects; // panel coordinates, guarded by _sdl_mutex
     uint_fast16_t _modified_counter;
     uint_fast16_t _texupdate_counter;
     uint_fast16_t _display_counter;
@@ -131,6 +134,8 @@ namespace lgfx
     static void _update_proc(void);
     static void _update_scaling(monitor_t * m, float sx, float sy);
     void sdl_invalidate(void) { _invalidated = true; }
+    void _add_dirty_rect(uint_fast16_t x, uint_fast16_t y, uint_fast16_t w, uint_fast16_t h);
+    void _add_dirty_all(void);
     void render_texture(SDL_Texture* texture, int tx, int ty, int tw, int th, float angle);
     bool initFrameBuffer(size_t width, size_t height);
     void deinitFrameBuffer(void);
@@ -21,10 +21,15 @@ Contributors:
 
 #include "v1/platforms/device.hpp"
 #include "v1/platforms/common.hpp"
+#include "v1/misc/Allocator.hpp"
 #include "v1/lgfx_filesystem_support.hpp"
 #include "v1/LGFXBase.hpp"
 #include "v1/LGFX_Sprite.hpp"
 #include "v1/LGFX_Button.hpp"
+#include "v1/LGFX_TextRunCache.hpp"
+#include "v1/LGFX_PngDecoder.hpp"
+#include "v1/LGFX_CompressedSprite.hpp"
+#include "v1/LGFX_SpriteAtlas.hpp"
 #include "v1/Light.hpp"
 
 // LCD / OLED